@@ -23,11 +23,75 @@
 #define REAL double
 #endif /* not SINGLE */
 
+/* To link two builds of Triangle into one program, say a single precision   */
+/*   library and a double precision library, compile one of them with the    */
+/*   TRIPREFIX compiler switch set to a prefix (-DTRIPREFIX=trif_, for       */
+/*   instance).  Every external name in triangle.c then begins with that     */
+/*   prefix; see internal/triprefix.h.  The CMake build compiles its single  */
+/*   precision library, trianglef, this way.                                 */
+
+#ifdef TRIPREFIX
+#include "internal/triprefix.h"
+#endif /* TRIPREFIX */
+
 /* If yours is not a Unix system, define the NO_TIMER compiler switch to     */
 /*   remove the Unix-specific timing code.                                   */
 
 /* #define NO_TIMER */
 
+/* If your system lacks POSIX threads, define the NO_THREADS compiler switch */
+/*   to remove the multithreaded code.  The -t switch is then accepted but   */
+/*   has no effect.                                                          */
+
+/* #define NO_THREADS */
+
+/* On Unix systems, blocks of memory at least as large as a huge page (two   */
+/*   megabytes) are mapped with mmap() instead of taken from malloc().  They */
+/*   are aligned to huge page boundaries, and on Linux the kernel is advised */
+/*   to back them with transparent huge pages.  (On a mesh of 5.5 million    */
+/*   triangles, this made triangulation and refinement 2-5% faster.)  Define */
+/*   the NO_MMAP compiler switch to take all blocks from malloc().  Define   */
+/*   the HUGETLB symbol to try the explicit huge pages of Linux              */
+/*   (MAP_HUGETLB) first; they are only there if the administrator has       */
+/*   reserved some.                                                          */
+
+/* #define NO_MMAP */
+/* #define HUGETLB */
+
+#ifndef NO_MMAP
+#if !defined(__unix__) && !defined(__APPLE__)
+#define NO_MMAP
+#endif
+#endif /* not NO_MMAP */
+
+/* With the -k switch, orientation and incircle tests on integer vertices    */
+/*   are computed exactly with 64-bit and 128-bit integers.  Define the      */
+/*   NO_INT128 compiler switch if your compiler lacks a 128-bit integer      */
+/*   type; the incircle tests then use floating-point arithmetic.  Single    */
+/*   precision and compilers other than gcc and clang always do.             */
+
+/* #define NO_INT128 */
+
+#ifndef NO_INT128
+#if defined(SINGLE) || !defined(__GNUC__) || !defined(__SIZEOF_INT128__)
+#define NO_INT128
+#endif
+#endif /* not NO_INT128 */
+
+/* The exact arithmetic normally finds the roundoff error of a product by    */
+/*   Dekker's method, splitting each factor in two, at a cost of about a     */
+/*   dozen floating-point operations.  Define the FMA compiler switch to     */
+/*   find it with one fused multiply-add (the C99 fma() function) instead.   */
+/*   FMA is never defined for you, even when the compiler reports a fast     */
+/*   hardware fma, so the predicates don't change with the -march flags.     */
+/*   Don't define FMA for a processor without the instruction, because fma() */
+/*   is then emulated in software, very slowly.  The results are the same    */
+/*   either way.  (But gcc also fuses ordinary multiplications and additions */
+/*   under -mfma, which changes the last bits of the coordinates of Steiner  */
+/*   points, unless -ffp-contract=off is also given.)                        */
+
+/* #define FMA */
+
 /* To insert lots of self-checks for internal errors, define the SELF_CHECK  */
 /*   symbol.  This will slow down the program significantly.  It is best to  */
 /*   define the symbol using the -DSELF_CHECK compiler switch, but you could */
@@ -55,6 +119,40 @@
 /* #define REDUCED */
 /* #define CDT_ONLY */
 
+/* To reduce the memory occupied by a mesh, define the COMPACT symbol.       */
+/*   Triangles, subsegments, and vertices then refer to each other by 32-bit */
+/*   indices instead of pointers, which roughly halves the size of each      */
+/*   triangle on a 64-bit machine.  Every link must be translated to an      */
+/*   address when it is followed, so Triangle runs a little more slowly, and */
+/*   a mesh can have at most 2^30 triangles and 2^30 subsegments.            */
+
+/* #define COMPACT */
+
+/* To keep the records that point location and the divide-and-conquer merge  */
+/*   walk through as small as possible, define the COLDSTORE symbol.  The    */
+/*   attributes and area bound of each triangle, and the attributes of each  */
+/*   vertex, then move out of the triangle and vertex records into separate  */
+/*   arrays, which hold one record per block item in the same order.  Each   */
+/*   triangle or vertex that has such a record keeps a pointer to it.        */
+/*   COLDSTORE can only pay off when there are several attributes per        */
+/*   triangle or vertex; with none, the records are unchanged.               */
+
+/* #define COLDSTORE */
+
+/* To store the coordinates of vertices in single precision, define the      */
+/*   FLOATCOORDS symbol.  The attributes of vertices are stored so too,      */
+/*   unless COLDSTORE moves them out of the vertex records.  Without -p, and */
+/*   with no attributes, a vertex then takes 16 bytes instead of 24.  Every  */
+/*   vertex is rounded to single precision as it is made, whether it comes   */
+/*   from the input or is a Steiner point, and trimeshquery() locates a      */
+/*   point by its rounded coordinates, though it finds the barycentric       */
+/*   coordinates of the point as given.  The coordinates are read back as    */
+/*   REALs before any arithmetic is done with them, so the predicates are    */
+/*   still exact, and everything else is still computed in double precision, */
+/*   unlike with SINGLE.                                                     */
+
+/* #define FLOATCOORDS */
+
 /* On some machines, my exact arithmetic routines might be defeated by the   */
 /*   use of internal extended precision floating-point registers.  The best  */
 /*   way to solve this problem is to set the floating-point registers to use */
@@ -92,9 +190,16 @@
 /*   following constants determine how many of each structure is allocated   */
 /*   at once.                                                                */
 
+#ifndef COMPACT
 #define TRIPERBLOCK 4092           /* Number of triangles allocated at once. */
 #define SUBSEGPERBLOCK 508       /* Number of subsegments allocated at once. */
 #define VERTEXPERBLOCK 4092         /* Number of vertices allocated at once. */
+#else /* COMPACT */
+/* With COMPACT, these must be multiples of INDEXCHUNK. */
+#define TRIPERBLOCK 4096           /* Number of triangles allocated at once. */
+#define SUBSEGPERBLOCK 1024      /* Number of subsegments allocated at once. */
+#define VERTEXPERBLOCK 4096         /* Number of vertices allocated at once. */
+#endif /* COMPACT */
 #define VIRUSPERBLOCK 1020   /* Number of virus triangles allocated at once. */
 /* Number of encroached subsegments allocated at once. */
 #define BADSUBSEGPERBLOCK 252
@@ -105,6 +210,105 @@
 /* Number of splay tree nodes allocated at once. */
 #define SPLAYNODEPERBLOCK 508
 
+/* The first blocks of vertices and triangles are sized to the input.  The   */
+/*   blocks that follow hold at least 1/BLOCKFRACTION as many items as the   */
+/*   first, so that a large mesh occupies a few large blocks.                */
+
+#define BLOCKFRACTION 16
+
+/* Unless NO_MMAP is defined, blocks of at least MAPBYTES bytes are mapped   */
+/*   with mmap(), in multiples of MAPBYTES and aligned to MAPBYTES.  It is   */
+/*   the size of a huge page.                                                */
+
+#define MAPBYTES (1ul << 21)
+
+/* The smallest subproblem (in vertices) that the divide-and-conquer         */
+/*   algorithm will hand off to a separate thread.  Smaller subproblems are  */
+/*   not worth the cost of creating a thread.                                */
+
+#define DIVCONQGRAIN 16384
+
+/* The smallest array of sort keys that will be sorted, merged, or           */
+/*   partitioned with the help of a separate thread.                         */
+
+#define SORTGRAIN 65536
+
+/* The smallest number of triangles or subsegments whose quality tests       */
+/*   tallyfaces() or tallyencs() will hand off to a separate thread.         */
+
+#define TALLYGRAIN 16384
+
+/* The smallest number of vertices whose edges bondscan() will hand off to a */
+/*   separate thread when reconstruct() rebuilds a mesh.                     */
+
+#define BONDGRAIN 16384
+
+/* With the -k switch, every input coordinate must be an integer of          */
+/*   magnitude less than INTEGERBOUND (2^30), so that the differences of     */
+/*   coordinates fit in 32 bits, and the incircle determinant in 128 bits.   */
+
+#define INTEGERBOUND 1073741824.0
+
+/* The smallest number of triangles in one step of a flood fill by plague()  */
+/*   or regionplague() that spreadscan() will hand off to a separate thread, */
+/*   and the smallest number of hole and region points that seedscan()       */
+/*   will hand off to a separate thread.                                     */
+
+#define SPREADGRAIN 4096
+#define SEEDGRAIN 256
+
+/* The smallest number of query points that trimeshquery() will hand off to  */
+/*   a separate thread.                                                      */
+
+#define QUERYGRAIN 4096
+
+/* The smallest number of PSLG segments that recoverpending() will scout or  */
+/*   insert with the help of a separate thread, and the most that            */
+/*   formskeleton() will hold for it at once.                                */
+
+#define SEGMENTGRAIN 1024
+#define SEGMENTWINDOW 16384
+
+/* The most triangles a segment may read or modify and still be inserted in  */
+/*   parallel with others.  Segments that reach further are inserted alone.  */
+
+#define FOOTPRINTSIZE 48
+
+/* The most triangles around a Steiner point inserted in parallel whose      */
+/*   quality splitround() has tested on several threads.  A point inserted   */
+/*   into a cavity of k triangles has k + 2 triangles around it.             */
+
+#define STARSIZE (FOOTPRINTSIZE + 2)
+
+/* With the -U switch, the number of bad triangles that splitround() takes   */
+/*   from the queue at once, and the smallest number of them that            */
+/*   splitscan() will scout or split with the help of a separate thread.     */
+
+#define STEINERWINDOW 4096
+#define STEINERGRAIN 512
+
+/* The number of bits per coordinate of the Hilbert curve used to order      */
+/*   vertices for incremental insertion.  A position along the curve has     */
+/*   twice as many bits, and is sorted as a REAL, so it must fit in the      */
+/*   24-bit significand of a float in single precision.                      */
+
+#ifdef SINGLE
+#define HILBERTORDER 12
+#else /* not SINGLE */
+#define HILBERTORDER 16
+#endif /* not SINGLE */
+
+/* With COMPACT, the items of the triangle, subsegment, and vertex pools are */
+/*   numbered in chunks of INDEXCHUNK consecutive items, and an index is     */
+/*   translated to an address by looking up the first item of its chunk.     */
+/*   INDEXCHUNK must be a power of two; INDEXCHUNKBITS is its logarithm.     */
+/*   DEADLINK marks deallocated triangles and subsegments.  It falls in the  */
+/*   first chunk, which no real triangle, subsegment, or vertex uses.        */
+
+#define INDEXCHUNKBITS 10
+#define INDEXCHUNK (1 << INDEXCHUNKBITS)
+#define DEADLINK ((unsigned int) (INDEXCHUNK - 1))
+
 /* The vertex types.   A DEADVERTEX has been deleted entirely.  An           */
 /*   UNDEADVERTEX is not part of the mesh, but is written to the output      */
 /*   .node file and affects the node indexing in the other output files.     */
@@ -176,6 +380,27 @@ enum insertvertexresult {SUCCESSFULVERTEX, ENCROACHINGVERTEX, VIOLATINGVERTEX,
 
 enum finddirectionresult {WITHIN, LEFTCOLLINEAR, RIGHTCOLLINEAR};
 
+/* Labels that signify which compiled copy of the hot kernels is used:  the  */
+/*   generic copy, which consults the switches and counts every test; a      */
+/*   copy with the adaptive filters alone; or a copy that tries the static   */
+/*   filters of the -f switch first.                                         */
+
+enum kernelmode {GENERICKERNEL, FILTERKERNEL, STATICKERNEL};
+
+/* Labels that signify how a PSLG segment can be inserted, as determined by  */
+/*   scoutpending():  it is already an edge of the triangulation; it can be  */
+/*   inserted by edge flips alone; or it meets a vertex or another segment,  */
+/*   or its neighborhood is unknown, so it must be inserted by itself.       */
+
+enum pendingkind {EDGEPENDING, CAVITYPENDING, LONEPENDING};
+
+/* Labels that signify what splitscan() does with its share of a round of    */
+/*   splitround():  find the circumcenters of the bad triangles, scout their */
+/*   cavities, insert the Steiner points chosen, or test the triangles       */
+/*   around the new vertices for quality.                                    */
+
+enum splitphase {CENTERPHASE, SCOUTPHASE, INSERTPHASE, JUDGEPHASE};
+
 /*****************************************************************************/
 /*                                                                           */
 /*  The basic mesh data structures                                           */
@@ -292,8 +517,15 @@ enum finddirectionresult {WITHIN, LEFTCOLLINEAR, RIGHTCOLLINEAR};
 /*   pointers for nodes, when the user asks for high-order elements.         */
 /*   Because the size and structure of a `triangle' is not decided until     */
 /*   runtime, I haven't simply declared the type `triangle' as a struct.     */
+/*                                                                           */
+/* If COMPACT is defined, the pointers are replaced by 32-bit indices, and   */
+/*   each triangle also records its own index.                               */
 
+#ifndef COMPACT
 typedef REAL **triangle;            /* Really:  typedef triangle *triangle   */
+#else /* COMPACT */
+typedef unsigned int triangle;
+#endif /* COMPACT */
 
 /* An oriented triangle:  includes a pointer to a triangle and orientation.  */
 /*   The orientation denotes an edge of the triangle.  Hence, there are      */
@@ -308,9 +540,14 @@ struct otri {
 /* The subsegment data structure.  Each subsegment contains two pointers to  */
 /*   adjoining subsegments, plus four pointers to vertices, plus two         */
 /*   pointers to adjoining triangles, plus one boundary marker, plus one     */
-/*   segment number.                                                         */
+/*   segment number.  If COMPACT is defined, the pointers are replaced by    */
+/*   32-bit indices, and each subsegment also records its own index.         */
 
+#ifndef COMPACT
 typedef REAL **subseg;                  /* Really:  typedef subseg *subseg   */
+#else /* COMPACT */
+typedef unsigned int subseg;
+#endif /* COMPACT */
 
 /* An oriented subsegment:  includes a pointer to a subsegment and an        */
 /*   orientation.  The orientation denotes a side of the edge.  Hence, there */
@@ -322,12 +559,19 @@ struct osub {
   int ssorient;                                       /* Ranges from 0 to 1. */
 };
 
-/* The vertex data structure.  Each vertex is actually an array of REALs.    */
-/*   The number of REALs is unknown until runtime.  An integer boundary      */
-/*   marker, and sometimes a pointer to a triangle, is appended after the    */
-/*   REALs.                                                                  */
+/* The vertex data structure.  Each vertex is actually an array of           */
+/*   VERTEXREALs (REALs, or floats if FLOATCOORDS is defined).  The number   */
+/*   of them is unknown until runtime.  An integer boundary marker, and      */
+/*   sometimes a pointer to a triangle, is appended after them.  If COMPACT  */
+/*   is defined, the vertex's own index is appended too.                     */
+
+#ifdef FLOATCOORDS
+#define VERTEXREAL float
+#else /* not FLOATCOORDS */
+#define VERTEXREAL REAL
+#endif /* not FLOATCOORDS */
 
-typedef REAL *vertex;
+typedef VERTEXREAL *vertex;
 
 /* A queue used to store encroached subsegments.  Each subsegment's vertices */
 /*   are stored so that we can check whether a subsegment is still the same. */
@@ -390,6 +634,17 @@ struct splaynode {
   struct splaynode *lchild, *rchild;              /* Children in splay tree. */
 };
 
+/* A sort key for a vertex.  The divide-and-conquer algorithm sorts these    */
+/*   packed keys, rather than the vertices themselves, so that comparisons   */
+/*   do not chase pointers into the vertex pool.  `index' is the vertex's    */
+/*   position in the unsorted array; it breaks ties between duplicate        */
+/*   vertices, so that the sorted order is unique.                           */
+
+struct vertexkey {
+  REAL coord[2];
+  int index;
+};
+
 /* A type used to allocate memory.  firstblock is the first block of items.  */
 /*   nowblock is the block from which items are currently being allocated.   */
 /*   nextitem points to the next slab of free memory for an item.            */
@@ -412,6 +667,31 @@ struct splaynode {
 /*   allocated items.  maxitems is the maximum number of items that have     */
 /*   been allocated at once; it is the current number of items plus the      */
 /*   number of records kept on deaditemstack.                                */
+/*                                                                           */
+/* If COMPACT is defined, the items of some pools are numbered.  Each item   */
+/*   stores its own index `indexoffset' bytes from its start.  chunkbase[i]  */
+/*   is the address of the item whose index is i * INDEXCHUNK; the item with */
+/*   index i * INDEXCHUNK + j follows it by j * itembytes bytes.  chunkslots */
+/*   is the length of chunkbase, and nextindex is the index that the first   */
+/*   item of the next new block will receive.  indexoffset is negative for   */
+/*   pools whose items are not numbered.                                     */
+/*                                                                           */
+/* If COLDSTORE is defined, each item of some pools has a companion record   */
+/*   of `companionbytes' bytes, allocated `itemsperblock' at a time in       */
+/*   blocks linked from `companions'.  Each item stores the address of its   */
+/*   companion record `companionoffset' bytes from its start.                */
+/*   companionoffset is negative for pools without companion records.        */
+/*                                                                           */
+/* Unless NO_MMAP is defined, mappedbytes is the number of bytes of the      */
+/*   pool's blocks that were mapped with mmap() rather than taken from the   */
+/*   heap.  If scratchdir isn't NULL, those blocks are mapped from scratch   */
+/*   files created in that directory.  poolinit() leaves scratchdir as it    */
+/*   finds it, so set it after poolzero() and before poolinit().             */
+/*                                                                           */
+/* If allocator isn't NULL, the pool's memory comes from the callbacks of a  */
+/*   library caller's arena (see triarenacreate()) rather than from          */
+/*   trimalloc() or mmap().  Like scratchdir, it is left alone by            */
+/*   poolinit(), and must not change while the pool holds any blocks.        */
 
 struct memorypool {
   VOID **firstblock, **nowblock;
@@ -426,25 +706,29 @@ struct memorypool {
   long items, maxitems;
   int unallocateditems;
   int pathitemsleft;
+#ifdef COMPACT
+  char **chunkbase;
+  long chunkslots;
+  unsigned long nextindex;
+  int indexoffset;
+  int reservedchunks;
+#endif /* COMPACT */
+#ifdef COLDSTORE
+  VOID *companions;
+  int companionoffset;
+  int companionbytes;
+#endif /* COLDSTORE */
+#ifndef NO_MMAP
+  unsigned long mappedbytes;
+  char *scratchdir;
+#endif /* not NO_MMAP */
+  struct triallocator *allocator;
 };
 
 
-/* Global constants.                                                         */
-
-REAL splitter;       /* Used to split REAL factors for exact multiplication. */
-REAL epsilon;                             /* Floating-point machine epsilon. */
-REAL resulterrbound;
-REAL ccwerrboundA, ccwerrboundB, ccwerrboundC;
-REAL iccerrboundA, iccerrboundB, iccerrboundC;
-REAL o3derrboundA, o3derrboundB, o3derrboundC;
-
-/* Random number seed is not constant, but I've made it global anyway.       */
-
-unsigned long randomseed;                     /* Current random number seed. */
-
-
 /* Mesh data structure.  Triangle operates on only one mesh, but the mesh    */
 /*   structure is used (instead of global variables) to allow reentrancy.    */
+/*   All of Triangle's mutable state lives here or in `struct behavior'.     */
 
 struct mesh {
 
@@ -461,6 +745,12 @@ struct mesh {
   struct memorypool flipstackers;
   struct memorypool splaynodes;
 
+/* The callbacks of the library caller's arena, or NULL.  If not NULL, they  */
+/*   supply the memory of the pools, of `dummytri' and `dummysub', and of    */
+/*   the output arrays.                                                      */
+
+  struct triallocator *allocator;
+
 /* Variables that maintain the bad triangle queues.  The queues are          */
 /*   ordered from 4095 (highest priority) to 0 (lowest priority).            */
 
@@ -473,6 +763,13 @@ struct mesh {
 
   struct flipstacker *lastflip;
 
+/* Triangles allocated in advance, which maketriangle() hands out before it  */
+/*   allocates any more.  A thread inserting a Steiner point alongside       */
+/*   others (see splitscan()) must not allocate from the shared pool.        */
+
+  triangle *sparetri[2];
+  int sparetris;
+
 /* Other variables. */
 
   REAL xmin, xmax, ymin, ymax;                            /* x and y bounds. */
@@ -493,18 +790,53 @@ struct mesh {
   int vertex2triindex;     /* Index to find a triangle adjacent to a vertex. */
   int highorderindex;  /* Index to find extra nodes for high-order elements. */
   int elemattribindex;            /* Index to find attributes of a triangle. */
+#ifdef COMPACT
+  int triselfindex;                 /* Index to find a triangle's own index. */
+  int vertexselfindex;                /* Index to find a vertex's own index. */
+  int elemnumberindex;      /* Index to find a triangle's number for output. */
+#endif /* COMPACT */
+#ifdef COLDSTORE
+  int tricoldindex;          /* Index to find a triangle's attribute record. */
+  int vertexcoldindex;         /* Index to find a vertex's attribute record. */
+#endif /* COLDSTORE */
   int areaboundindex;             /* Index to find area bound of a triangle. */
   int checksegments;         /* Are there segments in the triangulation yet? */
   int checkquality;                  /* Has quality triangulation begun yet? */
+  int spatialorder;  /* Is each vertex inserted near its predecessor (BRIO)? */
   int readnodefile;                           /* Has a .node file been read? */
   long samples;              /* Number of random samples for point location. */
 
   long incirclecount;                 /* Number of incircle tests performed. */
   long counterclockcount;     /* Number of counterclockwise tests performed. */
+  long iccstaticcount, ccwstaticcount;   /* Tests decided by static filters. */
+  long iccexactcount, ccwexactcount;      /* Tests needing exact arithmetic. */
   long orient3dcount;           /* Number of 3D orientation tests performed. */
   long hyperbolacount;      /* Number of right-of-hyperbola tests performed. */
   long circumcentercount;  /* Number of circumcenter calculations performed. */
   long circletopcount;       /* Number of circle top calculations performed. */
+  long locatecount;                  /* Number of searches made by locate(). */
+  long locatewalkcount;     /* Number of triangles walked by those searches. */
+  long walkcount;          /* Number of triangles walked by preciselocate(). */
+  long gridlocatecount;    /* Number of searches begun from the locate grid. */
+
+/* Constants for exact arithmetic, computed by exactinit().  They are kept   */
+/*   here, rather than in global variables, so that several threads may      */
+/*   triangulate independent meshes at once.                                 */
+
+  REAL splitter;     /* Used to split REAL factors for exact multiplication. */
+  REAL epsilon;                           /* Floating-point machine epsilon. */
+  REAL resulterrbound;
+  REAL ccwerrboundA, ccwerrboundB, ccwerrboundC;
+  REAL iccerrboundA, iccerrboundB, iccerrboundC;
+  REAL o3derrboundA, o3derrboundB, o3derrboundC;
+  int integerexact;             /* Are tests done with integers (-k switch)? */
+  int staticexact;            /* Are static filters tried first (-f switch)? */
+  REAL filterxmin, filterxmax, filterymin, filterymax;  /* Box of all points */
+                                                 /*   tested, for -f switch. */
+  REAL ccwstaticbound, iccstaticbound;      /* Static filters' error bounds. */
+  enum kernelmode kernel;               /* Compiled copy of the hot kernels. */
+
+  unsigned long randomseed;                   /* Current random number seed. */
 
 /* Triangular bounding box vertices.                                         */
 
@@ -527,6 +859,17 @@ struct mesh {
 
   struct otri recenttri;
 
+/* Grid of triangles used for point location (-G switch).  Each cell holds a */
+/*   triangle near the cell, or a NULL triangle.  The grid covers the        */
+/*   bounding box of the input vertices with `gridwidth' by `gridheight'     */
+/*   cells; `gridxscale' and `gridyscale' convert distances to cell units.   */
+/*   `gridvertices' is the number of vertices when the grid was built.       */
+
+  struct otri *locategrid;
+  int gridwidth, gridheight;
+  REAL gridxscale, gridyscale;
+  long gridvertices;
+
 };                                                  /* End of `struct mesh'. */
 
 
@@ -554,13 +897,17 @@ struct behavior {
 /*   nobound: -B switch.  nopolywritten: -P switch.                          */
 /*   nonodewritten: -N switch.  noelewritten: -E switch.                     */
 /*   noiterationnum: -I switch.  noholes: -O switch.                         */
-/*   noexact: -X switch.                                                     */
+/*   noexact: -X switch.  integer: -k switch.  staticfilter: -f switch.      */
 /*   order: element order, specified after -o switch.                        */
 /*   nobisect: count of how often -Y switch is selected.                     */
 /*   steiner: maximum number of Steiner points, specified after -S switch.   */
 /*   incremental: -i switch.  sweepline: -F switch.                          */
 /*   dwyer: inverse of -l switch.                                            */
 /*   splitseg: -s switch.                                                    */
+/*   threads: number of threads, specified after -t switch.                  */
+/*   steinerrounds: -U switch.                                               */
+/*   gridlocate: -G switch.  relayout: -M switch.                            */
+/*   outofcore: -T switch.                                                   */
 /*   conformdel: -D switch.  docheck: -C switch.                             */
 /*   quiet: -Q switch.  verbose: count of how often -V switch is selected.   */
 /*   usesegments: -p, -r, -q, or -c switch; determines whether segments are  */
@@ -573,9 +920,12 @@ struct behavior {
   int firstnumber;
   int edgesout, voronoi, neighbors, geomview;
   int nobound, nopolywritten, nonodewritten, noelewritten, noiterationnum;
-  int noholes, noexact, conformdel;
+  int noholes, noexact, integer, staticfilter, conformdel;
   int incremental, sweepline, dwyer;
   int splitseg;
+  int threads, steinerrounds;
+  int gridlocate, relayout;
+  int outofcore;
   int docheck;
   int quiet, verbose;
   int usesegments;
@@ -585,8 +935,10 @@ struct behavior {
   REAL minangle, goodangle, offconstant;
   REAL maxarea;
 
-/* Variables for file names.                                                 */
+/* Variables for file names.  scratchdir is the directory named after the    */
+/*   -T switch.                                                              */
 
+  char scratchdir[FILENAMESIZE];
 #ifndef TRILIBRARY
   char innodefilename[FILENAMESIZE];
   char inelefilename[FILENAMESIZE];
@@ -604,6 +956,288 @@ struct behavior {
 
 };                                              /* End of `struct behavior'. */
 
+/* The library's interface, which declares struct triallocator (a copy of   */
+/*   which an arena keeps) as well as struct triangulateio.                  */
+
+#ifdef TRILIBRARY
+#include "public/triangle.h"
+#endif /* TRILIBRARY */
+
+/* A mesh that outlives the call that built it, returned to the library's    */
+/*   caller by trimeshcreate().  `holelist' and `regionlist' are the         */
+/*   caller's arrays, handed back with each export as triangulate() does.    */
+/*   `qualitypools' is set once enforcequality() has initialized the pools   */
+/*   of encroached subsegments and bad triangles.                            */
+
+#ifdef TRILIBRARY
+
+struct trimesh {
+  struct mesh m;
+  struct behavior b;
+  REAL *holelist;
+  REAL *regionlist;
+  int qualitypools;
+};
+
+/* Pools kept from one triangulation to the next by an arena, returned to    */
+/*   the library's caller by triarenacreate().  `callbacks' is the caller's  */
+/*   allocator, and `allocator' points to it, or is NULL if the caller gave  */
+/*   none.  Between calls, the pools hold blocks but no items; see           */
+/*   arenaload() and arenakeep().                                            */
+
+struct triarena {
+  struct triallocator callbacks;
+  struct triallocator *allocator;
+  struct memorypool triangles;
+  struct memorypool subsegs;
+  struct memorypool vertices;
+  struct memorypool badsubsegs;
+  struct memorypool badtriangles;
+  struct memorypool flipstackers;
+};
+
+#endif /* TRILIBRARY */
+
+/* A handle for a thread started by startthread().  When Triangle is         */
+/*   compiled without threads, no thread is ever started, and the handle is  */
+/*   a placeholder.                                                          */
+
+#ifdef NO_THREADS
+typedef int trithread;
+#else /* not NO_THREADS */
+#include <pthread.h>
+typedef pthread_t trithread;
+#endif /* not NO_THREADS */
+
+/* A subproblem of the divide-and-conquer algorithm that has been handed to  */
+/*   a separate thread.  `m' is a private copy of the mesh; see the comments */
+/*   preceding divconqfork() for how its triangle pool is arranged.          */
+/*   `farleft' and `farright' receive the hull edges of the triangulation.   */
+
+struct divconqtask {
+  struct mesh *m;
+  struct behavior *b;
+  vertex *sortarray;
+  int vertices, axis, depth;
+  struct otri farleft, farright;
+};
+
+/* Subproblems of the vertex sorting routines that have been handed to       */
+/*   separate threads.  See vertexsort(), keymerge(), and alternateaxes().   */
+
+struct keysorttask {
+  struct vertexkey *keys, *scratch;
+  int arraysize, intoscratch, depth;
+};
+
+struct keymergetask {
+  struct vertexkey *left, *right, *dest;
+  int leftsize, rightsize, depth;
+};
+
+struct keyaxestask {
+  struct vertexkey *keys;
+  int arraysize, axis, depth;
+  unsigned long seed;
+};
+
+/* A share of the triangles or subsegments tested by tallyfaces() or         */
+/*   tallyencs(), which may be handed to a separate thread.  Each test of    */
+/*   `items[i]' stores a verdict in `verdicts[i]' and, for a triangle, the   */
+/*   square of its shortest edge in `minedges[i]'.                           */
+
+struct tallytask {
+  struct mesh *m;
+  struct behavior *b;
+  VOID **items;
+  REAL *minedges;
+  char *verdicts;
+  int count, subsegs, depth;
+};
+
+/* The half-edges of a mesh read by reconstruct(), bucketed by vertex for    */
+/*   bondscan(), which bonds the triangles of a share of the vertices and    */
+/*   may hand some of them to a separate thread.  Half-edge 3k + j is edge j */
+/*   of `tris[k]', running from vertex `corners[3k + j]' to the next corner. */
+/*   The half-edges whose smaller endpoint is vertex v are listed in order,  */
+/*   from `halfedges[first[v]]' to `halfedges[first[v + 1] - 1]'.            */
+
+struct bondtask {
+  struct mesh *m;
+  triangle **tris;
+  int *corners;
+  int *first, *halfedges;
+  int vertexlo, count, depth;
+};
+
+/* A boundary edge of a mesh read by reconstruct(), identified by the number */
+/*   of its origin and by its half-edge.  See hulledgecompare().             */
+
+struct hulledge {
+  int org, halfedge;
+};
+
+/* A share of the hole and region points that carveholes() locates in one    */
+/*   batch, which may be handed to a separate thread.  seedscan() visits the */
+/*   points in the order of `keys', and stores the triangle it finds for     */
+/*   point i (at `points[2i]') in `seeds[i]', and the kind of location in    */
+/*   `results[i]'.                                                           */
+
+struct seedtask {
+  struct mesh *m;
+  struct behavior *b;
+  vertex points;
+  struct vertexkey *keys;
+  struct otri *seeds;
+  enum locateresult *results;
+  int count, depth;
+};
+
+/* The work that spreadscan() does on the triangles of a flood fill:  look   */
+/*   at their neighbors (and, for regionplague(), apply an attribute and     */
+/*   area constraint), find the vertices that die with them, disconnect them */
+/*   from the survivors, or uninfect them.                                   */
+
+enum spreadphase {SPREADSCAN, SPREADPAINT, SPREADKILL, SPREADCUT, SPREADHEAL};
+
+/* A neighbor of a triangle visited by a flood fill, as spreadscan() found   */
+/*   it:  the neighboring triangle, the subsegment between them, and whether */
+/*   the neighbor exists and was not yet infected.                           */
+
+struct spreadedge {
+  struct otri neighbor;
+  struct osub subseg;
+  int live;
+};
+
+/* A share of the triangles handled by one phase of spreadscan(), which may  */
+/*   be handed to a separate thread.  A scan stores the neighbors of         */
+/*   `tris[i]' in `edges[3i]' through `edges[3i + 2]'.  The changes made to  */
+/*   `m->hullsize' and `m->undeads' are returned in `hullchange' and         */
+/*   `undeads'.                                                              */
+
+struct spreadtask {
+  struct mesh *m;
+  struct behavior *b;
+  triangle **tris;
+  struct spreadedge *edges;
+  REAL attribute, area;
+  long hullchange, undeads;
+  enum spreadphase phase;
+  int count, depth;
+};
+
+/* A PSLG segment awaiting insertion by recoverpending().  scoutpending()    */
+/*   records how it can be inserted (`kind'); the triangle from which to     */
+/*   insert it (`start'); the triangle that insertsegment() would leave in   */
+/*   `m->recenttri' (`recent'); the triangles that vertex2tri() gives for    */
+/*   its endpoints (`anchor'), unless they are out of date, so that          */
+/*   insertsegment() must call locate() (`located'); and its footprint, the  */
+/*   `size' triangles that inserting it would read, of which the first       */
+/*   `writes' it would modify.  `finish' is the new edge once the edges      */
+/*   crossing it have been flipped.                                          */
+
+struct pendingseg {
+  vertex endpoint1, endpoint2;
+  struct otri start, recent, finish;
+  triangle *anchor[2];
+  triangle *footprint[FOOTPRINTSIZE];
+  int mark;
+  int writes, size;
+  enum pendingkind kind;
+  int located, batch;
+};
+
+/* A share of the segments scouted by recoverpending(), or of the segments   */
+/*   it inserts in parallel (if `carve' is set), which may be handed to a    */
+/*   separate thread with its own copy of the mesh (for the statistics).     */
+
+struct pendingtask {
+  struct mesh *m;
+  struct behavior *b;
+  struct pendingseg **segs;
+  int count, carve, depth;
+};
+
+/* A bad triangle awaiting a Steiner point from splitround(), which records  */
+/*   whether the triangle has changed since it was queued (`stale') and, if  */
+/*   not, its circumcenter, with the `xi' and `eta' that findcircumcenter()  */
+/*   gives.  scoutsplit() records the triangle from which insertvertex()     */
+/*   will find the circumcenter at once (`start'), and the footprint of the  */
+/*   insertion, the `size' triangles that inserting it would touch.  The     */
+/*   first `writes' of them, whose circumcircles contain the circumcenter,   */
+/*   it would replace; of the rest, the neighbors of those, it would change  */
+/*   only the links to them (and the last may be the bad triangle itself,    */
+/*   which is merely read).  A circumcenter that can't be inserted without   */
+/*   touching a subsegment or the boundary, or whose footprint is too large  */
+/*   to record, is `lone'.  `newvertex' and `newtri' are allocated for it if */
+/*   it joins the batch.  Once it is inserted, the first `judged' triangles  */
+/*   around it, in the order insertvertex() would test them, have their      */
+/*   judgetriangle() results stored in `verdicts' and `minedges'.            */
+
+struct pendingsplit {
+  struct badtriang *badtri;
+  struct otri start;
+  vertex newvertex;
+  triangle *newtri[2];
+  triangle *footprint[FOOTPRINTSIZE];
+  VERTEXREAL center[2];
+  REAL xi, eta;
+  REAL minedges[STARSIZE];
+  char verdicts[STARSIZE];
+  int writes, size, judged;
+  int stale, lone, batch;
+};
+
+/* A share of a round of splitround(), to be worked on in the given `phase', */
+/*   which may be handed to a separate thread with its own copy of the mesh. */
+
+struct splittask {
+  struct mesh *m;
+  struct behavior *b;
+  struct pendingsplit **splits;
+  enum splitphase phase;
+  int count, depth;
+};
+
+/* A triangle and its number in the output.  trimeshquery() sorts these by   */
+/*   address, to number the triangles that contain its query points.         */
+
+struct trinumber {
+  triangle *tri;
+  int number;
+};
+
+/* A uniform grid of buckets, each listing the triangles whose bounding      */
+/*   boxes overlap it.  See makebuckets().                                   */
+
+struct tribuckets {
+  triangle **tris;
+  int *first;
+  int width, height;
+  REAL xscale, yscale;
+};
+
+/* A share of the query points located by trimeshquery(), which may be       */
+/*   handed to a separate thread with its own copy of the mesh (so that      */
+/*   locate() may keep its own recent triangle and random seed).  `keys'     */
+/*   lists the points in Hilbert order.  `buckets' is NULL if the mesh is    */
+/*   convex, so that locate() can be trusted to find every point in it.      */
+
+struct querytask {
+  struct mesh *m;
+  struct behavior *b;
+  REAL *querylist;
+  struct vertexkey *keys;
+  struct trinumber *numbers;
+  struct tribuckets *buckets;
+  int *trianglelist;
+  REAL *barylist;
+  REAL *attriblist;
+  long triangles;
+  int count, found, depth;
+};
+
 
 /*****************************************************************************/
 /*                                                                           */
@@ -723,6 +1357,8 @@ extern int minus1mod3[3];
 /*                                                                           */
 /*                                                                           */
 
+#ifndef COMPACT
+
 /* decode() converts a pointer to an oriented triangle.  The orientation is  */
 /*   extracted from the two least significant bits of the pointer.           */
 
@@ -738,6 +1374,55 @@ extern int minus1mod3[3];
 #define encode(otri)                                                          \
   (triangle) ((unsigned long) (otri).tri | (unsigned long) (otri).orient)
 
+/* encodevertex() and decodevertex() convert a vertex to the form in which   */
+/*   it is stored in a triangle or subsegment, and back.  dummytrilink and   */
+/*   dummysublink are `dummytri' and `dummysub' in stored form.              */
+
+#define encodevertex(vx)  (triangle) (vx)
+
+#define decodevertex(link)  (vertex) (link)
+
+#define dummytrilink  (triangle) m->dummytri
+
+#define dummysublink  (subseg) m->dummysub
+
+#else /* COMPACT */
+
+/* decode() converts an index to an oriented triangle.  The orientation is   */
+/*   held in the two least significant bits of the index.                    */
+
+#define decode(ptr, otri)                                                     \
+  (otri).orient = (int) ((ptr) & 3u);                                         \
+  (otri).tri = (triangle *)                                                   \
+    (m->triangles.chunkbase[(ptr) >> (INDEXCHUNKBITS + 2)] +                  \
+     (((ptr) >> 2) & (INDEXCHUNK - 1)) *                                      \
+     (unsigned long) m->triangles.itembytes)
+
+/* encode() compresses an oriented triangle into a single index.             */
+
+#define encode(otri)                                                          \
+  (triangle) (((otri).tri[m->triselfindex] << 2) |                            \
+              (unsigned int) (otri).orient)
+
+/* encodevertex() and decodevertex() convert a vertex to an index and back.  */
+/*   A NULL vertex has index zero.  `dummytri' and `dummysub' have index     */
+/*   zero as well.                                                           */
+
+#define encodevertex(vx)                                                      \
+  ((vx) == (vertex) NULL ? 0u :                                               \
+   ((unsigned int *) (vx))[m->vertexselfindex])
+
+#define decodevertex(link)                                                    \
+  (vertex) (m->vertices.chunkbase[(link) >> INDEXCHUNKBITS] +                 \
+            ((link) & (INDEXCHUNK - 1)) *                                     \
+            (unsigned long) m->vertices.itembytes)
+
+#define dummytrilink  (triangle) 0
+
+#define dummysublink  (subseg) 0
+
+#endif /* COMPACT */
+
 /* The following handle manipulation primitives are all described by Guibas  */
 /*   and Stolfi.  However, Guibas and Stolfi use an edge-based data          */
 /*   structure, whereas I use a triangle-based data structure.               */
@@ -852,22 +1537,50 @@ extern int minus1mod3[3];
 /* triangle.                                                                 */
 
 #define org(otri, vertexptr)                                                  \
-  vertexptr = (vertex) (otri).tri[plus1mod3[(otri).orient] + 3]
+  vertexptr = decodevertex((otri).tri[plus1mod3[(otri).orient] + 3])
 
 #define dest(otri, vertexptr)                                                 \
-  vertexptr = (vertex) (otri).tri[minus1mod3[(otri).orient] + 3]
+  vertexptr = decodevertex((otri).tri[minus1mod3[(otri).orient] + 3])
 
 #define apex(otri, vertexptr)                                                 \
-  vertexptr = (vertex) (otri).tri[(otri).orient + 3]
+  vertexptr = decodevertex((otri).tri[(otri).orient + 3])
 
 #define setorg(otri, vertexptr)                                               \
-  (otri).tri[plus1mod3[(otri).orient] + 3] = (triangle) vertexptr
+  (otri).tri[plus1mod3[(otri).orient] + 3] = encodevertex(vertexptr)
 
 #define setdest(otri, vertexptr)                                              \
-  (otri).tri[minus1mod3[(otri).orient] + 3] = (triangle) vertexptr
+  (otri).tri[minus1mod3[(otri).orient] + 3] = encodevertex(vertexptr)
 
 #define setapex(otri, vertexptr)                                              \
-  (otri).tri[(otri).orient + 3] = (triangle) vertexptr
+  (otri).tri[(otri).orient + 3] = encodevertex(vertexptr)
+
+/* The sweepline algorithm parks a pointer to a circle event in the origin   */
+/*   of a triangle.  With COMPACT, the event's position in the array         */
+/*   `eventarray', plus one, is stored instead; zero means no event.  The    */
+/*   array is named in both builds, so callers need not depend on COMPACT.   */
+
+#ifndef COMPACT
+
+#define eventorg(otri, eventarray)                                            \
+  ((void) (eventarray),                                                       \
+   (struct event *) (otri).tri[plus1mod3[(otri).orient] + 3])
+
+#define seteventorg(otri, eventarray, eventptr)                               \
+  (void) (eventarray);                                                        \
+  (otri).tri[plus1mod3[(otri).orient] + 3] = (triangle) (eventptr)
+
+#else /* COMPACT */
+
+#define eventorg(otri, eventarray)                                            \
+  ((otri).tri[plus1mod3[(otri).orient] + 3] == 0 ? (struct event *) NULL :    \
+   &(eventarray)[(otri).tri[plus1mod3[(otri).orient] + 3] - 1])
+
+#define seteventorg(otri, eventarray, eventptr)                               \
+  (otri).tri[plus1mod3[(otri).orient] + 3] =                                  \
+    ((eventptr) == (struct event *) NULL ? 0 :                                \
+     (triangle) ((eventptr) - (eventarray)) + 1)
+
+#endif /* COMPACT */
 
 /* Bond two triangles together.                                              */
 
@@ -881,7 +1594,7 @@ extern int minus1mod3[3];
 /*   it doesn't matter.                                                      */
 
 #define dissolve(otri)                                                        \
-  (otri).tri[(otri).orient] = (triangle) m->dummytri
+  (otri).tri[(otri).orient] = dummytrilink
 
 /* Copy an oriented triangle.                                                */
 
@@ -911,25 +1624,58 @@ extern int minus1mod3[3];
 #define infected(otri)                                                        \
   (((unsigned long) (otri).tri[6] & (unsigned long) 2l) != 0l)
 
+/* Find the REALs that hold a triangle's attributes and area bound.  With    */
+/*   COLDSTORE they live in a separate record, whose address the triangle    */
+/*   stores.                                                                 */
+
+#ifndef COLDSTORE
+
+#define elemcold(otri)  ((REAL *) (otri).tri)
+
+#else /* COLDSTORE */
+
+#define elemcold(otri)  ((REAL **) (otri).tri)[m->tricoldindex]
+
+#endif /* COLDSTORE */
+
 /* Check or set a triangle's attributes.                                     */
 
 #define elemattribute(otri, attnum)                                           \
-  ((REAL *) (otri).tri)[m->elemattribindex + (attnum)]
+  elemcold(otri)[m->elemattribindex + (attnum)]
 
 #define setelemattribute(otri, attnum, value)                                 \
-  ((REAL *) (otri).tri)[m->elemattribindex + (attnum)] = value
+  elemcold(otri)[m->elemattribindex + (attnum)] = value
 
 /* Check or set a triangle's maximum area bound.                             */
 
-#define areabound(otri)  ((REAL *) (otri).tri)[m->areaboundindex]
+#define areabound(otri)  elemcold(otri)[m->areaboundindex]
 
 #define setareabound(otri, value)                                             \
-  ((REAL *) (otri).tri)[m->areaboundindex] = value
+  elemcold(otri)[m->areaboundindex] = value
+
+/* Access the integer by which the Voronoi and neighbor output number a      */
+/*   triangle.  Ordinarily it overwrites whatever follows the vertices; with */
+/*   COMPACT it has a slot of its own, so the mesh stays intact.             */
+
+#ifndef COMPACT
+
+#define elemnumber(tria)  (* (int *) ((tria) + 6))
+
+#else /* COMPACT */
+
+#define elemnumber(tria)  ((int *) (tria))[m->elemnumberindex]
+
+#endif /* COMPACT */
 
 /* Check or set a triangle's deallocation.  Its second pointer is set to     */
 /*   NULL to indicate that it is not allocated.  (Its first pointer is used  */
 /*   for the stack of dead items.)  Its fourth pointer (its first vertex)    */
 /*   is set to NULL in case a `badtriang' structure points to it.            */
+/*                                                                           */
+/* With COMPACT, the stack of dead items overwrites the first two indices,   */
+/*   so the fourth index (the first vertex) is set to DEADLINK instead.      */
+
+#ifndef COMPACT
 
 #define deadtri(tria)  ((tria)[1] == (triangle) NULL)
 
@@ -937,10 +1683,21 @@ extern int minus1mod3[3];
   (tria)[1] = (triangle) NULL;                                                \
   (tria)[3] = (triangle) NULL
 
+#else /* COMPACT */
+
+#define deadtri(tria)  ((tria)[3] == DEADLINK)
+
+#define killtri(tria)                                                         \
+  (tria)[3] = DEADLINK
+
+#endif /* COMPACT */
+
 /********* Primitives for subsegments                                *********/
 /*                                                                           */
 /*                                                                           */
 
+#ifndef COMPACT
+
 /* sdecode() converts a pointer to an oriented subsegment.  The orientation  */
 /*   is extracted from the least significant bit of the pointer.  The two    */
 /*   least significant bits (one for orientation, one for viral infection)   */
@@ -958,6 +1715,26 @@ extern int minus1mod3[3];
 #define sencode(osub)                                                         \
   (subseg) ((unsigned long) (osub).ss | (unsigned long) (osub).ssorient)
 
+#else /* COMPACT */
+
+/* sdecode() converts an index to an oriented subsegment.  As with pointers, */
+/*   the least significant bit holds the orientation and the next bit is     */
+/*   reserved for viral infection.  A subsegment's own index follows its     */
+/*   boundary marker.                                                        */
+
+#define sdecode(sptr, osub)                                                   \
+  (osub).ssorient = (int) ((sptr) & 1u);                                      \
+  (osub).ss = (subseg *)                                                      \
+    (m->subsegs.chunkbase[(sptr) >> (INDEXCHUNKBITS + 2)] +                   \
+     (((sptr) >> 2) & (INDEXCHUNK - 1)) * (unsigned long) m->subsegs.itembytes)
+
+/* sencode() compresses an oriented subsegment into a single index.          */
+
+#define sencode(osub)                                                         \
+  (subseg) (((osub).ss[9] << 2) | (unsigned int) (osub).ssorient)
+
+#endif /* COMPACT */
+
 /* ssym() toggles the orientation of a subsegment.                           */
 
 #define ssym(osub1, osub2)                                                    \
@@ -993,28 +1770,28 @@ extern int minus1mod3[3];
 /*   subsegment or the segment that includes it.                             */
 
 #define sorg(osub, vertexptr)                                                 \
-  vertexptr = (vertex) (osub).ss[2 + (osub).ssorient]
+  vertexptr = decodevertex((osub).ss[2 + (osub).ssorient])
 
 #define sdest(osub, vertexptr)                                                \
-  vertexptr = (vertex) (osub).ss[3 - (osub).ssorient]
+  vertexptr = decodevertex((osub).ss[3 - (osub).ssorient])
 
 #define setsorg(osub, vertexptr)                                              \
-  (osub).ss[2 + (osub).ssorient] = (subseg) vertexptr
+  (osub).ss[2 + (osub).ssorient] = (subseg) encodevertex(vertexptr)
 
 #define setsdest(osub, vertexptr)                                             \
-  (osub).ss[3 - (osub).ssorient] = (subseg) vertexptr
+  (osub).ss[3 - (osub).ssorient] = (subseg) encodevertex(vertexptr)
 
 #define segorg(osub, vertexptr)                                               \
-  vertexptr = (vertex) (osub).ss[4 + (osub).ssorient]
+  vertexptr = decodevertex((osub).ss[4 + (osub).ssorient])
 
 #define segdest(osub, vertexptr)                                              \
-  vertexptr = (vertex) (osub).ss[5 - (osub).ssorient]
+  vertexptr = decodevertex((osub).ss[5 - (osub).ssorient])
 
 #define setsegorg(osub, vertexptr)                                            \
-  (osub).ss[4 + (osub).ssorient] = (subseg) vertexptr
+  (osub).ss[4 + (osub).ssorient] = (subseg) encodevertex(vertexptr)
 
 #define setsegdest(osub, vertexptr)                                           \
-  (osub).ss[5 - (osub).ssorient] = (subseg) vertexptr
+  (osub).ss[5 - (osub).ssorient] = (subseg) encodevertex(vertexptr)
 
 /* These primitives read or set a boundary marker.  Boundary markers are     */
 /*   used to hold user-defined tags for setting boundary conditions in       */
@@ -1035,7 +1812,7 @@ extern int minus1mod3[3];
 /*   subsegment will still think it's connected to this subsegment.          */
 
 #define sdissolve(osub)                                                       \
-  (osub).ss[(osub).ssorient] = (subseg) m->dummysub
+  (osub).ss[(osub).ssorient] = dummysublink
 
 /* Copy a subsegment.                                                        */
 
@@ -1053,6 +1830,10 @@ extern int minus1mod3[3];
 /*   NULL to indicate that it is not allocated.  (Its first pointer is used  */
 /*   for the stack of dead items.)  Its third pointer (its first vertex)     */
 /*   is set to NULL in case a `badsubseg' structure points to it.            */
+/*                                                                           */
+/* With COMPACT, the third index (the first vertex) is set to DEADLINK.      */
+
+#ifndef COMPACT
 
 #define deadsubseg(sub)  ((sub)[1] == (subseg) NULL)
 
@@ -1060,6 +1841,15 @@ extern int minus1mod3[3];
   (sub)[1] = (subseg) NULL;                                                   \
   (sub)[2] = (subseg) NULL
 
+#else /* COMPACT */
+
+#define deadsubseg(sub)  ((sub)[2] == DEADLINK)
+
+#define killsubseg(sub)                                                       \
+  (sub)[2] = DEADLINK
+
+#endif /* COMPACT */
+
 /********* Primitives for interacting triangles and subsegments      *********/
 /*                                                                           */
 /*                                                                           */
@@ -1086,12 +1876,12 @@ extern int minus1mod3[3];
 /* Dissolve a bond (from the triangle side).                                 */
 
 #define tsdissolve(otri)                                                      \
-  (otri).tri[6 + (otri).orient] = (triangle) m->dummysub
+  (otri).tri[6 + (otri).orient] = (triangle) dummysublink
 
 /* Dissolve a bond (from the subsegment side).                               */
 
 #define stdissolve(osub)                                                      \
-  (osub).ss[6 + (osub).ssorient] = (subseg) m->dummytri
+  (osub).ss[6 + (osub).ssorient] = (subseg) dummytrilink
 
 /********* Primitives for vertices                                   *********/
 /*                                                                           */
@@ -1107,6 +1897,27 @@ extern int minus1mod3[3];
 #define setvertextype(vx, value)                                              \
   ((int *) (vx))[m->vertexmarkindex + 1] = value
 
+/* vertexattribs() finds the attributes of a vertex, which follow its        */
+/*   coordinates, or with COLDSTORE, live in a separate record.              */
+
+#ifndef COLDSTORE
+
+#define vertexattribs(vx)  (&(vx)[2])
+
+#else /* COLDSTORE */
+
+#define vertexattribs(vx)  ((REAL **) (vx))[m->vertexcoldindex]
+
+#endif /* COLDSTORE */
+
+/* vertexattrib() and setvertexattrib() access the attributes of a vertex.  */
+/*   vertexattrib() reads an attribute as a REAL, even if it is stored as a  */
+/*   float, so arithmetic on attributes is never done in single precision.   */
+
+#define vertexattrib(vx, i)  ((REAL) vertexattribs(vx)[i])
+
+#define setvertexattrib(vx, i, value)  vertexattribs(vx)[i] = (value)
+
 #define vertex2tri(vx)  ((triangle *) (vx))[m->vertex2triindex]
 
 #define setvertex2tri(vx, value)                                              \
@@ -0,0 +1,252 @@
+#ifndef INTERNAL_TRIPREFIX_H
+#define INTERNAL_TRIPREFIX_H
+
+/*****************************************************************************/
+/*                                                                           */
+/*  (triprefix.h)                                                            */
+/*                                                                           */
+/*  Names every external procedure and variable of Triangle with the prefix  */
+/*  given by the TRIPREFIX compiler switch, so that two builds of Triangle   */
+/*  (say, a single precision library compiled with -DSINGLE                  */
+/*  -DTRIPREFIX=trif_ and the usual double precision library) can be linked  */
+/*  into the same program.  Included by internal/triangle.h when TRIPREFIX   */
+/*  is defined.                                                              */
+/*                                                                           */
+/*  Any procedure or variable added to triangle.c without "static" must be   */
+/*  added to this list too.  triunsuitable() is on the list because, with    */
+/*  the EXTERNAL_TEST switch, the calling program supplies it under the      */
+/*  prefixed name.  The structure tags triangulateio, trimesh,               */
+/*  triallocator, and triarena are renamed as public/triangle.h renames      */
+/*  them.                                                                    */
+/*                                                                           */
+/*****************************************************************************/
+
+#define TRIPASTE(prefix, name) prefix ## name
+#define TRIPREFIXED(prefix, name) TRIPASTE(prefix, name)
+#define TRINAME(name) TRIPREFIXED(TRIPREFIX, name)
+
+#define alternateaxes TRINAME(alternateaxes)
+#define alternateaxesthread TRINAME(alternateaxesthread)
+#define arenakeep TRINAME(arenakeep)
+#define arenaload TRINAME(arenaload)
+#define badsubsegdealloc TRINAME(badsubsegdealloc)
+#define badsubsegtraverse TRINAME(badsubsegtraverse)
+#define bondhull TRINAME(bondhull)
+#define bondinit TRINAME(bondinit)
+#define bondlookup TRINAME(bondlookup)
+#define bondscan TRINAME(bondscan)
+#define bondthread TRINAME(bondthread)
+#define boundingbox TRINAME(boundingbox)
+#define bucketcolumn TRINAME(bucketcolumn)
+#define bucketlocate TRINAME(bucketlocate)
+#define bucketrow TRINAME(bucketrow)
+#define carveholes TRINAME(carveholes)
+#define carvesegment TRINAME(carvesegment)
+#define check4deadevent TRINAME(check4deadevent)
+#define checkdelaunay TRINAME(checkdelaunay)
+#define checkmesh TRINAME(checkmesh)
+#define checkseg4encroach TRINAME(checkseg4encroach)
+#define choosekernel TRINAME(choosekernel)
+#define circletop TRINAME(circletop)
+#define circletopinsert TRINAME(circletopinsert)
+#define conformingedge TRINAME(conformingedge)
+#define constrainededge TRINAME(constrainededge)
+#define counterclockwise TRINAME(counterclockwise)
+#define counterclockwiseadapt TRINAME(counterclockwiseadapt)
+#define counterclockwiseinteger TRINAME(counterclockwiseinteger)
+#define createeventheap TRINAME(createeventheap)
+#define delaunay TRINAME(delaunay)
+#define delaunayfixup TRINAME(delaunayfixup)
+#define deletevertex TRINAME(deletevertex)
+#define dequeuebadtriang TRINAME(dequeuebadtriang)
+#define divconqdelaunay TRINAME(divconqdelaunay)
+#define divconqfork TRINAME(divconqfork)
+#define divconqrecurse TRINAME(divconqrecurse)
+#define divconqthread TRINAME(divconqthread)
+#define dummyinit TRINAME(dummyinit)
+#define enforcequality TRINAME(enforcequality)
+#define enqueuebadtri TRINAME(enqueuebadtri)
+#define enqueuebadtriang TRINAME(enqueuebadtriang)
+#define estimate TRINAME(estimate)
+#define eventheapdelete TRINAME(eventheapdelete)
+#define eventheapify TRINAME(eventheapify)
+#define eventheapinsert TRINAME(eventheapinsert)
+#define exactinit TRINAME(exactinit)
+#define fast_expansion_sum_zeroelim TRINAME(fast_expansion_sum_zeroelim)
+#define filterstatistics TRINAME(filterstatistics)
+#define findcircumcenter TRINAME(findcircumcenter)
+#define finddirection TRINAME(finddirection)
+#define flip TRINAME(flip)
+#define footprintadd TRINAME(footprintadd)
+#define footprintslot TRINAME(footprintslot)
+#define footprintstar TRINAME(footprintstar)
+#define forkdepth TRINAME(forkdepth)
+#define formskeleton TRINAME(formskeleton)
+#define frontlocate TRINAME(frontlocate)
+#define getvertex TRINAME(getvertex)
+#define highorder TRINAME(highorder)
+#define hilbertindex TRINAME(hilbertindex)
+#define hulledgecompare TRINAME(hulledgecompare)
+#define incircle TRINAME(incircle)
+#define incircleadapt TRINAME(incircleadapt)
+#define incircleinteger TRINAME(incircleinteger)
+#define incrementaldelaunay TRINAME(incrementaldelaunay)
+#define infecthull TRINAME(infecthull)
+#define initializetrisubpools TRINAME(initializetrisubpools)
+#define initializevertexpool TRINAME(initializevertexpool)
+#define insertsegment TRINAME(insertsegment)
+#define insertsubseg TRINAME(insertsubseg)
+#define insertvertex TRINAME(insertvertex)
+#define integerinit TRINAME(integerinit)
+#define integerpoint TRINAME(integerpoint)
+#define internalerror TRINAME(internalerror)
+#define jointhread TRINAME(jointhread)
+#define judgetriangle TRINAME(judgetriangle)
+#define keymerge TRINAME(keymerge)
+#define keymergethread TRINAME(keymergethread)
+#define keyrank TRINAME(keyrank)
+#define locate TRINAME(locate)
+#define locategridcell TRINAME(locategridcell)
+#define locateseeds TRINAME(locateseeds)
+#define makebuckets TRINAME(makebuckets)
+#define makelocategrid TRINAME(makelocategrid)
+#define makesubseg TRINAME(makesubseg)
+#define maketriangle TRINAME(maketriangle)
+#define makevertexmap TRINAME(makevertexmap)
+#define markhull TRINAME(markhull)
+#define mergehulls TRINAME(mergehulls)
+#define minus1mod3 TRINAME(minus1mod3)
+#define nonregular TRINAME(nonregular)
+#define numbernodes TRINAME(numbernodes)
+#define orient3d TRINAME(orient3d)
+#define orient3dadapt TRINAME(orient3dadapt)
+#define outputadvise TRINAME(outputadvise)
+#define parsecommandline TRINAME(parsecommandline)
+#define pendingscan TRINAME(pendingscan)
+#define pendingthread TRINAME(pendingthread)
+#define plague TRINAME(plague)
+#define plus1mod3 TRINAME(plus1mod3)
+#define pooladvise TRINAME(pooladvise)
+#define poolalloc TRINAME(poolalloc)
+#define poolblockalloc TRINAME(poolblockalloc)
+#define poolblockbytes TRINAME(poolblockbytes)
+#define poolblockfree TRINAME(poolblockfree)
+#define poolblockitems TRINAME(poolblockitems)
+#define poolblockmapped TRINAME(poolblockmapped)
+#define poolcompanionblock TRINAME(poolcompanionblock)
+#define poolcompanioninit TRINAME(poolcompanioninit)
+#define poolcompanionlone TRINAME(poolcompanionlone)
+#define poolcopyitem TRINAME(poolcopyitem)
+#define pooldealloc TRINAME(pooldealloc)
+#define pooldeinit TRINAME(pooldeinit)
+#define poolindexblock TRINAME(poolindexblock)
+#define poolindexinit TRINAME(poolindexinit)
+#define poolinit TRINAME(poolinit)
+#define poolinitlike TRINAME(poolinitlike)
+#define poollayout TRINAME(poollayout)
+#define poolrestart TRINAME(poolrestart)
+#define poolreuse TRINAME(poolreuse)
+#define poolzero TRINAME(poolzero)
+#define preciselocate TRINAME(preciselocate)
+#define precisionerror TRINAME(precisionerror)
+#define printsubseg TRINAME(printsubseg)
+#define printtriangle TRINAME(printtriangle)
+#define quality_statistics TRINAME(quality_statistics)
+#define queryscan TRINAME(queryscan)
+#define querythread TRINAME(querythread)
+#define randomnation TRINAME(randomnation)
+#define reconstruct TRINAME(reconstruct)
+#define recoverpending TRINAME(recoverpending)
+#define regionplague TRINAME(regionplague)
+#define relayoutlink TRINAME(relayoutlink)
+#define relayoutmesh TRINAME(relayoutmesh)
+#define relayouttriangles TRINAME(relayouttriangles)
+#define relayoutvertices TRINAME(relayoutvertices)
+#define removebox TRINAME(removebox)
+#define removeghosts TRINAME(removeghosts)
+#define rightofhyperbola TRINAME(rightofhyperbola)
+#define scale_expansion_zeroelim TRINAME(scale_expansion_zeroelim)
+#define scanlocate TRINAME(scanlocate)
+#define scoutendpoint TRINAME(scoutendpoint)
+#define scoutpending TRINAME(scoutpending)
+#define scoutsegment TRINAME(scoutsegment)
+#define scoutsplit TRINAME(scoutsplit)
+#define seedscan TRINAME(seedscan)
+#define seedthread TRINAME(seedthread)
+#define segencroachment TRINAME(segencroachment)
+#define segmentintersection TRINAME(segmentintersection)
+#define segmentscross TRINAME(segmentscross)
+#define splay TRINAME(splay)
+#define splayinsert TRINAME(splayinsert)
+#define splitencsegs TRINAME(splitencsegs)
+#define splitround TRINAME(splitround)
+#define splitscan TRINAME(splitscan)
+#define splitthread TRINAME(splitthread)
+#define splittriangle TRINAME(splittriangle)
+#define spreadinfection TRINAME(spreadinfection)
+#define spreadregions TRINAME(spreadregions)
+#define spreadscan TRINAME(spreadscan)
+#define spreadthread TRINAME(spreadthread)
+#define startthread TRINAME(startthread)
+#define staticbounds TRINAME(staticbounds)
+#define staticfiltergrow TRINAME(staticfiltergrow)
+#define staticfilterinit TRINAME(staticfilterinit)
+#define statistics TRINAME(statistics)
+#define subsegdealloc TRINAME(subsegdealloc)
+#define subsegtraverse TRINAME(subsegtraverse)
+#define sweeplinedelaunay TRINAME(sweeplinedelaunay)
+#define tallyencs TRINAME(tallyencs)
+#define tallyfaces TRINAME(tallyfaces)
+#define tallyinit TRINAME(tallyinit)
+#define tallyscan TRINAME(tallyscan)
+#define tallythread TRINAME(tallythread)
+#define testtriangle TRINAME(testtriangle)
+#define threadmesh TRINAME(threadmesh)
+#define threadmeshjoin TRINAME(threadmeshjoin)
+#define transfernodes TRINAME(transfernodes)
+#define traversalinit TRINAME(traversalinit)
+#define traverse TRINAME(traverse)
+#define triallocator TRINAME(triallocator)
+#define triangledealloc TRINAME(triangledealloc)
+#define triangledeinit TRINAME(triangledeinit)
+#define triangleinit TRINAME(triangleinit)
+#define triangletraverse TRINAME(triangletraverse)
+#define triangulate TRINAME(triangulate)
+#define triangulateio TRINAME(triangulateio)
+#define triangulatepolygon TRINAME(triangulatepolygon)
+#define triarena TRINAME(triarena)
+#define triarenacreate TRINAME(triarenacreate)
+#define triarenadestroy TRINAME(triarenadestroy)
+#define triarenatriangulate TRINAME(triarenatriangulate)
+#define triclassify TRINAME(triclassify)
+#define triexit TRINAME(triexit)
+#define trifree TRINAME(trifree)
+#define trifreewith TRINAME(trifreewith)
+#define trimalloc TRINAME(trimalloc)
+#define trimallocwith TRINAME(trimallocwith)
+#define trimesh TRINAME(trimesh)
+#define trimeshcreate TRINAME(trimeshcreate)
+#define trimeshdestroy TRINAME(trimeshdestroy)
+#define trimeshexport TRINAME(trimeshexport)
+#define trimeshinsert TRINAME(trimeshinsert)
+#define trimeshlocatecounts TRINAME(trimeshlocatecounts)
+#define trimeshquery TRINAME(trimeshquery)
+#define trimeshrefine TRINAME(trimeshrefine)
+#define trinumbercompare TRINAME(trinumbercompare)
+#define triunsuitable TRINAME(triunsuitable)
+#define undovertex TRINAME(undovertex)
+#define unflip TRINAME(unflip)
+#define vertexdealloc TRINAME(vertexdealloc)
+#define vertexmedian TRINAME(vertexmedian)
+#define vertexsort TRINAME(vertexsort)
+#define vertexsortthread TRINAME(vertexsortthread)
+#define vertextraverse TRINAME(vertextraverse)
+#define walklocate TRINAME(walklocate)
+#define writeedges TRINAME(writeedges)
+#define writeelements TRINAME(writeelements)
+#define writeneighbors TRINAME(writeneighbors)
+#define writenodes TRINAME(writenodes)
+#define writepoly TRINAME(writepoly)
+#define writevoronoi TRINAME(writevoronoi)
+
+#endif /* INTERNAL_TRIPREFIX_H */
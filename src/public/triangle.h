@@ -71,6 +71,18 @@
 /*    points with identical copies.)                                         */
 /*  - The `I' (no iteration numbers) and `g' (.off file output) switches     */
 /*    have no effect when Triangle is compiled with TRILIBRARY defined.      */
+/*  - The `t' (threads) switch speeds up the Delaunay triangulation on       */
+/*    machines with several processors, without changing the output.  It     */
+/*    requires linking with the POSIX threads library, unless Triangle is    */
+/*    compiled with NO_THREADS defined.                                      */
+/*  - The `U' switch inserts the Steiner points of `q' and `a' in rounds,    */
+/*    many at once, on the threads of `t'.  Its output is the same for any   */
+/*    number of threads, but differs from the output without `U'.  It        */
+/*    obeys the same angle and area constraints.                             */
+/*                                                                           */
+/*  triangulate() keeps all of its working state in memory private to each   */
+/*  call, so several threads may call it at once, provided they pass         */
+/*  distinct input and output structures.                                    */
 /*                                                                           */
 /*  `in', `out', and `vorout' are descriptions of the input, the output,     */
 /*  and the Voronoi output.  If the `v' (Voronoi output) switch is not used, */
@@ -248,6 +260,167 @@
 /*                                                                           */
 /*****************************************************************************/
 
+/*****************************************************************************/
+/*                                                                           */
+/*  Mesh handles                                                             */
+/*                                                                           */
+/*  A program that refines the same mesh again and again (say, once per time */
+/*  step of an adaptive simulation) need not pay for triangulate() to build  */
+/*  the mesh anew, with the `r' switch, from its own previous output.        */
+/*  Instead, trimeshcreate() builds a mesh exactly as triangulate() would,   */
+/*  from the same switches and the same `in', and returns a handle on it.    */
+/*  The mesh lives until the handle is passed to trimeshdestroy().  Between  */
+/*  these calls, any sequence of the following may be used.                  */
+/*                                                                           */
+/*    - trimeshinsert() inserts `numberofpoints' more vertices, given by     */
+/*      `pointlist', `pointattributelist', and `pointmarkerlist' just as in  */
+/*      `in' (the latter two may be NULL, giving zeros).  A vertex that      */
+/*      falls on a segment splits it; a vertex that falls outside the mesh   */
+/*      (or in a hole) or on an existing vertex is not inserted.  Returns    */
+/*      the number of vertices inserted.                                     */
+/*    - trimeshrefine() adds Steiner points until the angle and area         */
+/*      constraints given to trimeshcreate() are met.  The handle must have  */
+/*      been created with the `q', `a', or `u' switch.  If                   */
+/*      `trianglearealist' is not NULL, the handle must have been created    */
+/*      with the `a' switch (with no number following), and the list gives   */
+/*      a new area constraint for each triangle, in the order the triangles  */
+/*      were written by the most recent trimeshexport().  (Any insertion     */
+/*      since that export renumbers the triangles.)                          */
+/*    - trimeshquery() locates `numberofqueries' points, given by            */
+/*      `querylist' (two coordinates each).  For each point, it writes the   */
+/*      number of the triangle that contains it to `trianglelist' (-1 for a  */
+/*      point outside the mesh), its three barycentric coordinates (with     */
+/*      respect to the triangle's corners, in the order in which they are    */
+/*      exported) to `barylist', and the vertex attributes interpolated at   */
+/*      the point to `attributelist'.  Any of these lists may be NULL.       */
+/*      Triangles are numbered as by the most recent trimeshexport().  The   */
+/*      points are located in an order that keeps successive searches short, */
+/*      and on several threads if the `t' switch was used.  Returns the      */
+/*      number of points that lie in the mesh.                               */
+/*    - trimeshexport() fills `out' and `vorout' as triangulate() would,     */
+/*      following the switches given to trimeshcreate().  The rules above    */
+/*      for initializing `out' and `vorout' apply to each export.            */
+/*    - trimeshlocatecounts() writes the number of point location searches   */
+/*      made in the mesh so far to `*searches', and the number of them that  */
+/*      began from the grid of the `G' switch to `*gridsearches'.            */
+/*                                                                           */
+/*  The `o2' switch may not be used with a handle.  Because the hole and     */
+/*  region lists of `in' are copied to `out' by each export, they must not   */
+/*  be freed before the handle is destroyed.                                 */
+/*                                                                           */
+/*****************************************************************************/
+
+/*****************************************************************************/
+/*                                                                           */
+/*  Arenas and allocators                                                    */
+/*                                                                           */
+/*  A program that triangulates many small inputs, one after another, spends */
+/*  a good share of its time allocating and freeing Triangle's memory pools. */
+/*  An arena keeps those pools from one call to the next.  triarenacreate()  */
+/*  returns an arena; triarenatriangulate() does just what triangulate()     */
+/*  does, taking its first argument as the arena to use; and                 */
+/*  triarenadestroy() frees the arena and the pools it has kept.  Each call  */
+/*  restarts the kept pools rather than freeing them, so after the first few */
+/*  calls, a triangulation of no more vertices than came before allocates    */
+/*  almost no memory for its mesh.  An arena may be used by one call at a    */
+/*  time; use one arena per thread to triangulate on several threads.        */
+/*                                                                           */
+/*  If the `allocator' passed to triarenacreate() is not NULL, its           */
+/*  callbacks (which are copied, so the structure need not outlive the       */
+/*  call) supply the memory of the arena, its pools, and every output array  */
+/*  that triarenatriangulate() allocates in `out' and `vorout'.              */
+/*  allocate(userdata, bytes) must return `bytes' bytes aligned for any      */
+/*  type, or NULL if it cannot (and Triangle will exit), and                 */
+/*  release(userdata, memptr) must free what allocate() returned.  Free the  */
+/*  output arrays with your release callback, not with trifree().  If the    */
+/*  `t' switch is used, the callbacks may be called from several threads at  */
+/*  once.  Triangle's short-lived working arrays still come from             */
+/*  trimalloc().  If `allocator' is NULL, everything comes from trimalloc()  */
+/*  as usual.                                                                */
+/*                                                                           */
+/*  The `T' switch still maps the large blocks of vertices and triangles     */
+/*  from scratch files when there is an allocator, because an allocator      */
+/*  can't supply memory backed by files; the allocator supplies the rest.    */
+/*  An arena doesn't keep pools backed by scratch files, so each call that   */
+/*  uses `T' maps its own.                                                   */
+/*                                                                           */
+/*  A COMPACT or COLDSTORE build numbers the items of its pools, or gives    */
+/*  them records, for one mesh only.  Such a build frees the pools after     */
+/*  each call, just as triangulate() does, but still allocates through the   */
+/*  arena's allocator.                                                       */
+/*                                                                           */
+/*****************************************************************************/
+
+/*****************************************************************************/
+/*                                                                           */
+/*  Two precisions in one program                                            */
+/*                                                                           */
+/*  A single precision Triangle (compiled with -DSINGLE) and a double        */
+/*  precision Triangle can be linked into the same program if one of them    */
+/*  is compiled with the TRIPREFIX symbol set to a prefix for all its        */
+/*  external names.  The CMake build makes two libraries this way:           */
+/*  `triangle', in double precision with the usual names, and `trianglef',   */
+/*  in single precision with every name prefixed by trif_.                   */
+/*                                                                           */
+/*  To call the prefixed library, define REAL and TRIPREFIX to match it      */
+/*  before including this file.  The procedures below, and the structures    */
+/*  triangulateio, trimesh, triallocator, and triarena, then take the        */
+/*  prefix.  This file may be included once for each library, like so:       */
+/*                                                                           */
+/*      #define REAL float                                                   */
+/*      #define TRIPREFIX trif_                                              */
+/*      #include "triangle.h"       (declares trif_triangulate(), etc.)      */
+/*      #undef REAL                                                          */
+/*      #undef TRIPREFIX                                                     */
+/*      #define REAL double                                                  */
+/*      #include "triangle.h"       (declares triangulate(), etc.)           */
+/*                                                                           */
+/*  Thereafter, call the prefixed procedures by their full names (and        */
+/*  declare `struct trif_triangulateio' for them).                           */
+/*                                                                           */
+/*****************************************************************************/
+
+#undef triangulateio
+#undef trimesh
+#undef triangulate
+#undef trifree
+#undef trimeshcreate
+#undef trimeshinsert
+#undef trimeshrefine
+#undef trimeshquery
+#undef trimeshexport
+#undef trimeshlocatecounts
+#undef trimeshdestroy
+#undef triallocator
+#undef triarena
+#undef triarenacreate
+#undef triarenatriangulate
+#undef triarenadestroy
+
+#ifdef TRIPREFIX
+#ifndef TRINAME
+#define TRIPASTE(prefix, name) prefix ## name
+#define TRIPREFIXED(prefix, name) TRIPASTE(prefix, name)
+#define TRINAME(name) TRIPREFIXED(TRIPREFIX, name)
+#endif /* not TRINAME */
+#define triangulateio TRINAME(triangulateio)
+#define trimesh TRINAME(trimesh)
+#define triangulate TRINAME(triangulate)
+#define trifree TRINAME(trifree)
+#define trimeshcreate TRINAME(trimeshcreate)
+#define trimeshinsert TRINAME(trimeshinsert)
+#define trimeshrefine TRINAME(trimeshrefine)
+#define trimeshquery TRINAME(trimeshquery)
+#define trimeshexport TRINAME(trimeshexport)
+#define trimeshlocatecounts TRINAME(trimeshlocatecounts)
+#define trimeshdestroy TRINAME(trimeshdestroy)
+#define triallocator TRINAME(triallocator)
+#define triarena TRINAME(triarena)
+#define triarenacreate TRINAME(triarenacreate)
+#define triarenatriangulate TRINAME(triarenatriangulate)
+#define triarenadestroy TRINAME(triarenadestroy)
+#endif /* TRIPREFIX */
+
 struct triangulateio {
   REAL *pointlist;                                               /* In / out */
   REAL *pointattributelist;                                      /* In / out */
@@ -279,11 +452,43 @@ struct triangulateio {
   int numberofedges;                                             /* Out only */
 };
 
+struct trimesh;             /* A mesh kept between calls; see Mesh handles. */
+
+struct triallocator {                  /* See Arenas and allocators, above. */
+  void *(*allocate)(void *userdata, unsigned long bytes);
+  void (*release)(void *userdata, void *memptr);
+  void *userdata;
+};
+
+struct triarena;    /* Pools kept between calls; see Arenas and allocators. */
+
 #ifdef ANSI_DECLARATORS
 void triangulate(char *, struct triangulateio *, struct triangulateio *,
                  struct triangulateio *);
 void trifree(VOID *memptr);
+struct trimesh *trimeshcreate(char *, struct triangulateio *);
+int trimeshinsert(struct trimesh *, int, REAL *, REAL *, int *);
+void trimeshrefine(struct trimesh *, REAL *);
+int trimeshquery(struct trimesh *, int, REAL *, int *, REAL *, REAL *);
+void trimeshexport(struct trimesh *, struct triangulateio *,
+                   struct triangulateio *);
+void trimeshlocatecounts(struct trimesh *, long *, long *);
+void trimeshdestroy(struct trimesh *);
+struct triarena *triarenacreate(struct triallocator *);
+void triarenatriangulate(struct triarena *, char *, struct triangulateio *,
+                         struct triangulateio *, struct triangulateio *);
+void triarenadestroy(struct triarena *);
 #else /* not ANSI_DECLARATORS */
 void triangulate();
 void trifree();
+struct trimesh *trimeshcreate();
+int trimeshinsert();
+void trimeshrefine();
+int trimeshquery();
+void trimeshexport();
+void trimeshlocatecounts();
+void trimeshdestroy();
+struct triarena *triarenacreate();
+void triarenatriangulate();
+void triarenadestroy();
 #endif /* not ANSI_DECLARATORS */
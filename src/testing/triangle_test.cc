@@ -1,6 +1,1404 @@
-// Tests for internal Triangle functions
+// Tests for the Triangle library
 
-#include "internal/triangle.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+#ifndef NO_THREADS
+#include <pthread.h>
+#endif /* not NO_THREADS */
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/stat.h>
+#include <unistd.h>
+#endif /* __unix__ or __APPLE__ */
+
+// All six libraries: `trianglef' in single precision, with the prefix
+//   trif_, `trianglec' with COMPACT mesh links, with the prefix tric_,
+//   `trianglefma' with FMA, with the prefix trifma_, `trianglefc' with
+//   FLOATCOORDS, with the prefix trifc_, `trianglecold' with COLDSTORE, with
+//   the prefix tricold_, and `triangle' in double precision.
+extern "C" {
+#define ANSI_DECLARATORS
+#define VOID void
+#define REAL float
+#define TRIPREFIX trif_
+#include "public/triangle.h"
+#undef REAL
+#undef TRIPREFIX
+#define REAL double
+#define TRIPREFIX tric_
+#include "public/triangle.h"
+#undef TRIPREFIX
+#define TRIPREFIX trifma_
+#include "public/triangle.h"
+#undef TRIPREFIX
+#define TRIPREFIX trifc_
+#include "public/triangle.h"
+#undef TRIPREFIX
+#define TRIPREFIX tricold_
+#include "public/triangle.h"
+#undef TRIPREFIX
+#include "public/triangle.h"
+}
 
 #include <cppunit/TestCase.h>
 #include <cppunit/extensions/HelperMacros.h>
+
+// With FLOATCOORDS (the TRIANGLE_FLOATCOORDS option), `triangle' rounds
+//   every vertex and attribute to single precision as it stores it, so the
+//   values it computes from them are that much further from exact.
+#ifdef FLOATCOORDS
+#define COORDROUNDOFF 1.0e-6
+#else /* not FLOATCOORDS */
+#define COORDROUNDOFF 0.0
+#endif /* not FLOATCOORDS */
+
+// An allocator that counts the blocks it has handed out and not taken back.
+struct CountingAllocator {
+  long allocated;
+  long live;
+};
+
+static void *countingAllocate(void *userdata, unsigned long bytes) {
+  CountingAllocator *counts = (CountingAllocator *) userdata;
+  counts->allocated++;
+  counts->live++;
+  return malloc(bytes);
+}
+
+static void countingRelease(void *userdata, void *memptr) {
+  CountingAllocator *counts = (CountingAllocator *) userdata;
+  counts->live--;
+  free(memptr);
+}
+
+// One call to triangulate(), to be made on a thread of its own.
+struct ConcurrentCall {
+  const char *switches;
+  struct triangulateio *in;
+  struct triangulateio out;
+};
+
+static void *concurrentTriangulate(void *callptr) {
+  ConcurrentCall *call = (ConcurrentCall *) callptr;
+  char copy[64];
+  strcpy(copy, call->switches);
+  memset(&call->out, 0, sizeof(call->out));
+  triangulate(copy, call->in, &call->out, (struct triangulateio *) NULL);
+  return NULL;
+}
+
+class TriangleTest : public CPPUNIT_NS::TestCase {
+  CPPUNIT_TEST_SUITE(TriangleTest);
+  CPPUNIT_TEST(testThreadsMatchSerial);
+  CPPUNIT_TEST(testConcurrentCalls);
+  CPPUNIT_TEST(testSteinerRounds);
+  CPPUNIT_TEST(testReconstruct);
+  CPPUNIT_TEST(testHolesAndRegions);
+  CPPUNIT_TEST(testMeshHandle);
+  CPPUNIT_TEST(testQuerySwitches);
+  CPPUNIT_TEST(testIncrementalOrder);
+  CPPUNIT_TEST(testRelayout);
+  CPPUNIT_TEST(testScratchFiles);
+  CPPUNIT_TEST(testThinGrid);
+  CPPUNIT_TEST(testIntegerExtremes);
+  CPPUNIT_TEST(testStaticFilters);
+  CPPUNIT_TEST(testFusedPredicates);
+  CPPUNIT_TEST(testBothPrecisions);
+  CPPUNIT_TEST(testCompactLinks);
+  CPPUNIT_TEST(testFloatCoords);
+  CPPUNIT_TEST(testColdStore);
+  CPPUNIT_TEST(testArenaAllocator);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  void setUp() {
+    seed = 1;
+  }
+  void tearDown() {}
+
+ protected:
+  // A fixed generator, so that every run triangulates the same points.
+  double random01() {
+    seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+    return (double) (seed >> 11) / 9007199254740992.0;
+  }
+
+  // Fills `in' with `count' random points in the unit square.
+  void randomPoints(struct triangulateio *in, std::vector<REAL> &points,
+                    int count) {
+    points.resize(2 * count);
+    for (int i = 0; i < 2 * count; i++) {
+      points[i] = random01();
+    }
+    memset(in, 0, sizeof(*in));
+    in->numberofpoints = count;
+    in->pointlist = &points[0];
+  }
+
+  // Fills `in' with a square with a square hole, and random points within.
+  void squareWithHole(struct triangulateio *in, std::vector<REAL> &points,
+                      std::vector<int> &segments, std::vector<REAL> &holes,
+                      int count) {
+    static const REAL corners[16] = {0.0, 0.0, 1.0, 0.0, 1.0, 1.0, 0.0, 1.0,
+                                     0.4, 0.4, 0.6, 0.4, 0.6, 0.6, 0.4, 0.6};
+    points.assign(corners, corners + 16);
+    while ((int) points.size() < 2 * (8 + count)) {
+      REAL x = random01();
+      REAL y = random01();
+      if ((x < 0.39) || (x > 0.61) || (y < 0.39) || (y > 0.61)) {
+        points.push_back(x);
+        points.push_back(y);
+      }
+    }
+    segments.clear();
+    for (int i = 0; i < 4; i++) {
+      segments.push_back(i);
+      segments.push_back((i + 1) % 4);
+      segments.push_back(4 + i);
+      segments.push_back(4 + (i + 1) % 4);
+    }
+    holes.assign(2, 0.5);
+    memset(in, 0, sizeof(*in));
+    in->numberofpoints = 8 + count;
+    in->pointlist = &points[0];
+    in->numberofsegments = 8;
+    in->segmentlist = &segments[0];
+    in->numberofholes = 1;
+    in->holelist = &holes[0];
+  }
+
+  // Triangulates `in' with `switches', writing the triangles and neighbors.
+  void triangulateWith(const char *switches, struct triangulateio *in,
+                       struct triangulateio *out) {
+    char copy[64];
+    strcpy(copy, switches);
+    memset(out, 0, sizeof(*out));
+    triangulate(copy, in, out, (struct triangulateio *) NULL);
+  }
+
+  void freeOutput(struct triangulateio *out) {
+    trifree(out->pointlist);
+    trifree(out->pointattributelist);
+    trifree(out->pointmarkerlist);
+    trifree(out->trianglelist);
+    trifree(out->triangleattributelist);
+    trifree(out->neighborlist);
+    trifree(out->segmentlist);
+    trifree(out->segmentmarkerlist);
+    trifree(out->edgelist);
+    trifree(out->edgemarkerlist);
+  }
+
+  // Asserts that two outputs have the same vertices and the same triangles,
+  //   numbered alike.
+  void assertSameMesh(struct triangulateio *a, struct triangulateio *b) {
+    CPPUNIT_ASSERT_EQUAL(a->numberofpoints, b->numberofpoints);
+    CPPUNIT_ASSERT_EQUAL(a->numberoftriangles, b->numberoftriangles);
+    CPPUNIT_ASSERT_EQUAL(a->numberofsegments, b->numberofsegments);
+    CPPUNIT_ASSERT(memcmp(a->pointlist, b->pointlist,
+                          2 * a->numberofpoints * sizeof(REAL)) == 0);
+    CPPUNIT_ASSERT(memcmp(a->trianglelist, b->trianglelist,
+                          3 * a->numberoftriangles * sizeof(int)) == 0);
+    if ((a->neighborlist != NULL) || (b->neighborlist != NULL)) {
+      CPPUNIT_ASSERT(a->neighborlist != NULL);
+      CPPUNIT_ASSERT(b->neighborlist != NULL);
+      CPPUNIT_ASSERT(memcmp(a->neighborlist, b->neighborlist,
+                            3 * a->numberoftriangles * sizeof(int)) == 0);
+    }
+    if ((a->segmentlist != NULL) || (b->segmentlist != NULL)) {
+      CPPUNIT_ASSERT(a->segmentlist != NULL);
+      CPPUNIT_ASSERT(b->segmentlist != NULL);
+      CPPUNIT_ASSERT(memcmp(a->segmentlist, b->segmentlist,
+                            2 * a->numberofsegments * sizeof(int)) == 0);
+    }
+  }
+
+  // Returns the triangles of `out', with their corners renumbered by
+  //   `number', each turned to begin with its lowest numbered corner, in
+  //   sorted order.
+  std::vector<std::vector<int> > sortedTriangles(struct triangulateio *out,
+                                                 std::vector<int> &number) {
+    std::vector<std::vector<int> > triangles(out->numberoftriangles);
+    for (int t = 0; t < out->numberoftriangles; t++) {
+      int corners[3];
+      for (int k = 0; k < 3; k++) {
+        corners[k] = number[out->trianglelist[3 * t + k]];
+      }
+      int first = (corners[0] < corners[1]) ?
+                  ((corners[0] < corners[2]) ? 0 : 2) :
+                  ((corners[1] < corners[2]) ? 1 : 2);
+      for (int k = 0; k < 3; k++) {
+        triangles[t].push_back(corners[(first + k) % 3]);
+      }
+    }
+    std::sort(triangles.begin(), triangles.end());
+    return triangles;
+  }
+
+  // Asserts that two outputs have the same vertices, the same triangles, and
+  //   the same segments, though any of them may be numbered differently.
+  //   Vertices are matched by their coordinates, so there must be no
+  //   duplicates among them.
+  void assertSameTriangles(struct triangulateio *a, struct triangulateio *b) {
+    CPPUNIT_ASSERT_EQUAL(a->numberofpoints, b->numberofpoints);
+    CPPUNIT_ASSERT_EQUAL(a->numberoftriangles, b->numberoftriangles);
+    CPPUNIT_ASSERT_EQUAL(a->numberofsegments, b->numberofsegments);
+    std::map<std::pair<REAL, REAL>, int> numbering;
+    for (int i = 0; i < a->numberofpoints; i++) {
+      numbering[std::make_pair(a->pointlist[2 * i],
+                               a->pointlist[2 * i + 1])] = i;
+    }
+    CPPUNIT_ASSERT_EQUAL(a->numberofpoints, (int) numbering.size());
+    std::vector<int> same(a->numberofpoints), renumber(b->numberofpoints);
+    for (int i = 0; i < a->numberofpoints; i++) {
+      same[i] = i;
+      std::map<std::pair<REAL, REAL>, int>::iterator match =
+        numbering.find(std::make_pair(b->pointlist[2 * i],
+                                      b->pointlist[2 * i + 1]));
+      CPPUNIT_ASSERT(match != numbering.end());
+      renumber[i] = match->second;
+    }
+    CPPUNIT_ASSERT(sortedTriangles(a, same) == sortedTriangles(b, renumber));
+    if ((a->segmentlist == NULL) && (b->segmentlist == NULL)) {
+      return;
+    }
+    CPPUNIT_ASSERT(a->segmentlist != NULL);
+    CPPUNIT_ASSERT(b->segmentlist != NULL);
+    std::vector<std::pair<int, int> > asegments, bsegments;
+    for (int i = 0; i < a->numberofsegments; i++) {
+      int a0 = a->segmentlist[2 * i], a1 = a->segmentlist[2 * i + 1];
+      int b0 = renumber[b->segmentlist[2 * i]];
+      int b1 = renumber[b->segmentlist[2 * i + 1]];
+      asegments.push_back(std::make_pair(std::min(a0, a1), std::max(a0, a1)));
+      bsegments.push_back(std::make_pair(std::min(b0, b1), std::max(b0, b1)));
+    }
+    std::sort(asegments.begin(), asegments.end());
+    std::sort(bsegments.begin(), bsegments.end());
+    CPPUNIT_ASSERT(asegments == bsegments);
+  }
+
+  // Fills `in' with a 64 by 64 square, `count' random points in it, and
+  //   short horizontal segments in 63 rows, 39 to a row, that don't cross
+  //   each other.  Eight long diagonal segments cross many of them.
+  void stripes(struct triangulateio *in, std::vector<REAL> &points,
+               std::vector<int> &segments, int count) {
+    static const REAL corners[8] = {0.0, 0.0, 64.0, 0.0, 64.0, 64.0,
+                                    0.0, 64.0};
+    points.assign(corners, corners + 8);
+    segments.clear();
+    for (int i = 0; i < 4; i++) {
+      segments.push_back(i);
+      segments.push_back((i + 1) % 4);
+    }
+    for (int i = 0; i < count; i++) {
+      points.push_back(64.0 * random01());
+      points.push_back(64.0 * random01());
+    }
+    for (int row = 1; row < 64; row++) {
+      for (int k = 0; k < 39; k++) {
+        segments.push_back((int) points.size() / 2);
+        points.push_back(1.6 * (REAL) k + 0.1);
+        points.push_back((REAL) row + 0.1 * random01());
+        segments.push_back((int) points.size() / 2);
+        points.push_back(1.6 * (REAL) k + 1.3);
+        points.push_back((REAL) row + 0.1 * random01());
+      }
+    }
+    for (int k = 0; k < 8; k++) {
+      segments.push_back((int) points.size() / 2);
+      points.push_back(8.0 * (REAL) k + 0.05);
+      points.push_back(0.05);
+      segments.push_back((int) points.size() / 2);
+      points.push_back(8.0 * (REAL) k + 7.9);
+      points.push_back(63.95);
+    }
+    memset(in, 0, sizeof(*in));
+    in->numberofpoints = (int) points.size() / 2;
+    in->pointlist = &points[0];
+    in->numberofsegments = (int) segments.size() / 2;
+    in->segmentlist = &segments[0];
+  }
+
+  void testThreadsMatchSerial() {
+    struct triangulateio in, serial, threaded;
+    std::vector<REAL> points, holes;
+    std::vector<int> segments;
+
+    randomPoints(&in, points, 20000);
+    triangulateWith("znQ", &in, &serial);
+    triangulateWith("znt4Q", &in, &threaded);
+    assertSameMesh(&serial, &threaded);
+    freeOutput(&serial);
+    freeOutput(&threaded);
+
+    squareWithHole(&in, points, segments, holes, 2000);
+    triangulateWith("pznqa0.0005Q", &in, &serial);
+    triangulateWith("pznqa0.0005t4Q", &in, &threaded);
+    assertSameMesh(&serial, &threaded);
+    freeOutput(&serial);
+    freeOutput(&threaded);
+
+    // Enough segments for recoverpending() to insert them on several
+    //   threads, some of which cross and must be split.
+    stripes(&in, points, segments, 20000);
+    CPPUNIT_ASSERT(in.numberofsegments >= 2048);
+    triangulateWith("pznQ", &in, &serial);
+    triangulateWith("pznt4Q", &in, &threaded);
+    CPPUNIT_ASSERT(serial.numberofpoints > in.numberofpoints);
+    CPPUNIT_ASSERT(serial.numberoftriangles > 2 * in.numberofpoints - 10);
+    assertSameMesh(&serial, &threaded);
+    freeOutput(&serial);
+    freeOutput(&threaded);
+  }
+
+  void testConcurrentCalls() {
+    static const char *switches[4] = {"znQ", "pznqa0.0005Q", "cznqAQ",
+                                      "pzneqa0.001t2Q"};
+    struct triangulateio in[4], serial[4];
+    std::vector<REAL> points[4], holes[4];
+    std::vector<int> segments[4];
+    ConcurrentCall calls[4];
+
+    // Different inputs and switches, so that any state left shared between
+    //   calls would make the meshes differ from those of serial calls.
+    randomPoints(&in[0], points[0], 20000);
+    squareWithHole(&in[1], points[1], segments[1], holes[1], 2000);
+    randomPoints(&in[2], points[2], 3000);
+    squareWithHole(&in[3], points[3], segments[3], holes[3], 500);
+    for (int k = 0; k < 4; k++) {
+      triangulateWith(switches[k], &in[k], &serial[k]);
+      calls[k].switches = switches[k];
+      calls[k].in = &in[k];
+    }
+
+#ifndef NO_THREADS
+    pthread_t threads[4];
+    for (int k = 0; k < 4; k++) {
+      CPPUNIT_ASSERT_EQUAL(0, pthread_create(&threads[k], NULL,
+                                             concurrentTriangulate,
+                                             &calls[k]));
+    }
+    for (int k = 0; k < 4; k++) {
+      CPPUNIT_ASSERT_EQUAL(0, pthread_join(threads[k], NULL));
+    }
+#else /* NO_THREADS */
+    for (int k = 0; k < 4; k++) {
+      concurrentTriangulate(&calls[k]);
+    }
+#endif /* NO_THREADS */
+
+    for (int k = 0; k < 4; k++) {
+      assertSameMesh(&serial[k], &calls[k].out);
+      CPPUNIT_ASSERT_EQUAL(serial[k].numberofedges,
+                           calls[k].out.numberofedges);
+      freeOutput(&serial[k]);
+      freeOutput(&calls[k].out);
+    }
+  }
+
+  // Asserts that no triangle of `out' has an angle under about 19.9
+  //   degrees, or an area over `maxarea'.
+  void assertQuality(struct triangulateio *out, REAL maxarea) {
+    for (int t = 0; t < out->numberoftriangles; t++) {
+      REAL len[3];
+      for (int k = 0; k < 3; k++) {
+        REAL *p = &out->pointlist[2 * out->trianglelist[3 * t + k]];
+        REAL *q = &out->pointlist[2 * out->trianglelist[3 * t + (k + 1) % 3]];
+        len[k] = (q[0] - p[0]) * (q[0] - p[0]) + (q[1] - p[1]) * (q[1] - p[1]);
+      }
+      // The smallest angle is opposite the shortest edge, and its sine is
+      //   twice the area over the lengths of the other two.
+      REAL shortest = len[0] < len[1] ? (len[0] < len[2] ? len[0] : len[2])
+                                      : (len[1] < len[2] ? len[1] : len[2]);
+      REAL area2 = doubleArea(out, t);
+      CPPUNIT_ASSERT(area2 > 0.0);
+      CPPUNIT_ASSERT(area2 * area2 >=
+                     0.34 * 0.34 * len[0] * len[1] * len[2] / shortest);
+      CPPUNIT_ASSERT(area2 <= 2.0 * maxarea);
+    }
+  }
+
+  void testSteinerRounds() {
+    struct triangulateio in, serial, threaded;
+    std::vector<REAL> points, holes;
+    std::vector<int> segments;
+
+    // Big enough that tallyfaces() and tallyencs() test the triangles on
+    //   several threads (more than 2 * TALLYGRAIN of them).
+    randomPoints(&in, points, 20000);
+    triangulateWith("cznqa0.00002Q", &in, &serial);
+    triangulateWith("cznqa0.00002t4Q", &in, &threaded);
+    CPPUNIT_ASSERT(serial.numberoftriangles > 32768);
+    assertSameMesh(&serial, &threaded);
+    freeOutput(&serial);
+    freeOutput(&threaded);
+
+    // With -U, the Steiner points go in by rounds, but the mesh doesn't
+    //   depend on the number of threads.
+    triangulateWith("cznqa0.00002UQ", &in, &serial);
+    triangulateWith("cznqa0.00002Ut4Q", &in, &threaded);
+    CPPUNIT_ASSERT(serial.numberoftriangles > 32768);
+    assertSameMesh(&serial, &threaded);
+    assertQuality(&serial, 0.00002);
+    freeOutput(&serial);
+    freeOutput(&threaded);
+
+    // Segments and a hole, so that some Steiner points encroach upon
+    //   subsegments and are left to splittriangle().
+    squareWithHole(&in, points, segments, holes, 2000);
+    triangulateWith("pznqa0.00005UQ", &in, &serial);
+    triangulateWith("pznqa0.00005Ut3Q", &in, &threaded);
+    assertSameMesh(&serial, &threaded);
+    assertQuality(&serial, 0.00005);
+    freeOutput(&serial);
+    freeOutput(&threaded);
+  }
+
+  void testReconstruct() {
+    static const char *switches[4] = {"rzn", "rpzn", "rpzna0.00005e",
+                                      "rpznq"};
+    struct triangulateio in, first, again, serial, threaded;
+    std::vector<REAL> points;
+
+    // Enough vertices for bondscan() to pair the edges on several threads.
+    randomPoints(&in, points, 40000);
+    triangulateWith("pczQ", &in, &first);
+
+    memset(&again, 0, sizeof(again));
+    again.numberofpoints = first.numberofpoints;
+    again.pointlist = first.pointlist;
+    again.pointmarkerlist = first.pointmarkerlist;
+    again.numberoftriangles = first.numberoftriangles;
+    again.numberofcorners = 3;
+    again.trianglelist = first.trianglelist;
+    again.numberofsegments = first.numberofsegments;
+    again.segmentlist = first.segmentlist;
+    again.segmentmarkerlist = first.segmentmarkerlist;
+
+    for (int k = 0; k < 4; k++) {
+      char copy[32];
+      strcpy(copy, switches[k]);
+      strcat(copy, "Q");
+      triangulateWith(copy, &again, &serial);
+      strcpy(copy, switches[k]);
+      strcat(copy, "t4Q");
+      triangulateWith(copy, &again, &threaded);
+      assertSameMesh(&serial, &threaded);
+      CPPUNIT_ASSERT_EQUAL(serial.numberofedges, threaded.numberofedges);
+      if (k < 2) {
+        // Without refinement, the mesh comes back as it went in.
+        CPPUNIT_ASSERT_EQUAL(first.numberoftriangles,
+                             serial.numberoftriangles);
+      }
+      freeOutput(&serial);
+      freeOutput(&threaded);
+    }
+    freeOutput(&first);
+  }
+
+  void testHolesAndRegions() {
+    struct triangulateio in, serial, threaded;
+    std::vector<REAL> points, holes, regions;
+    std::vector<int> segments;
+
+    // A 32 by 32 square holding a checkerboard of 1024 small squares, 512
+    //   of them holes and 512 of them regions with their own attributes and
+    //   area bounds.  The random points fill the holes with triangles, so
+    //   that each step of the infection reaches many at once.
+    static const REAL corners[8] = {0.0, 0.0, 32.0, 0.0, 32.0, 32.0,
+                                    0.0, 32.0};
+    points.assign(corners, corners + 8);
+    segments.clear();
+    for (int i = 0; i < 4; i++) {
+      segments.push_back(i);
+      segments.push_back((i + 1) % 4);
+    }
+    for (int i = 0; i < 32; i++) {
+      for (int j = 0; j < 32; j++) {
+        int first = (int) points.size() / 2;
+        REAL square[8] = {0.2, 0.2, 0.8, 0.2, 0.8, 0.8, 0.2, 0.8};
+        for (int k = 0; k < 4; k++) {
+          points.push_back((REAL) i + square[2 * k]);
+          points.push_back((REAL) j + square[2 * k + 1]);
+          segments.push_back(first + k);
+          segments.push_back(first + (k + 1) % 4);
+        }
+        if ((i + j) % 2 == 0) {
+          holes.push_back((REAL) i + 0.5);
+          holes.push_back((REAL) j + 0.5);
+        } else {
+          regions.push_back((REAL) i + 0.5);
+          regions.push_back((REAL) j + 0.5);
+          regions.push_back((REAL) (32 * i + j));
+          regions.push_back(0.001 * (REAL) (1 + (i + j) % 5));
+        }
+      }
+    }
+    for (int i = 0; i < 60000; i++) {
+      points.push_back(32.0 * random01());
+      points.push_back(32.0 * random01());
+    }
+    memset(&in, 0, sizeof(in));
+    in.numberofpoints = (int) points.size() / 2;
+    in.pointlist = &points[0];
+    in.numberofsegments = (int) segments.size() / 2;
+    in.segmentlist = &segments[0];
+    in.numberofholes = (int) holes.size() / 2;
+    in.holelist = &holes[0];
+    in.numberofregions = (int) regions.size() / 4;
+    in.regionlist = &regions[0];
+
+    triangulateWith("pznAaQ", &in, &serial);
+    triangulateWith("pznAat4Q", &in, &threaded);
+    assertSameMesh(&serial, &threaded);
+    CPPUNIT_ASSERT_EQUAL(1, threaded.numberoftriangleattributes);
+    CPPUNIT_ASSERT(memcmp(serial.triangleattributelist,
+                          threaded.triangleattributelist,
+                          serial.numberoftriangles * sizeof(REAL)) == 0);
+    freeOutput(&serial);
+    freeOutput(&threaded);
+  }
+
+  // Twice the signed area of triangle `t' of `out'.
+  REAL doubleArea(struct triangulateio *out, int t) {
+    REAL *a = &out->pointlist[2 * out->trianglelist[3 * t]];
+    REAL *b = &out->pointlist[2 * out->trianglelist[3 * t + 1]];
+    REAL *c = &out->pointlist[2 * out->trianglelist[3 * t + 2]];
+    return (b[0] - a[0]) * (c[1] - a[1]) - (b[1] - a[1]) * (c[0] - a[0]);
+  }
+
+  void testMeshHandle() {
+    struct triangulateio in, direct, exported;
+    std::vector<REAL> points, holes;
+    std::vector<int> segments;
+    char switches[] = "pzqjaQ";
+
+    squareWithHole(&in, points, segments, holes, 50);
+    struct trimesh *mesh = trimeshcreate(switches, &in);
+    CPPUNIT_ASSERT(mesh != NULL);
+
+    // A new handle exports just what triangulate() writes.
+    triangulateWith("pzqjaQ", &in, &direct);
+    memset(&exported, 0, sizeof(exported));
+    trimeshexport(mesh, &exported, (struct triangulateio *) NULL);
+    assertSameMesh(&direct, &exported);
+    freeOutput(&direct);
+    int before = exported.numberofpoints;
+    freeOutput(&exported);
+
+    // Two new vertices, one in the hole, one outside, and one already there.
+    //   With the -j switch, the three that are not inserted are not written.
+    REAL extra[10] = {0.2, 0.3, 0.8, 0.75, 0.5, 0.5, 2.0, 2.0, 0.0, 0.0};
+    CPPUNIT_ASSERT_EQUAL(2, trimeshinsert(mesh, 5, extra, (REAL *) NULL,
+                                          (int *) NULL));
+    memset(&exported, 0, sizeof(exported));
+    trimeshexport(mesh, &exported, (struct triangulateio *) NULL);
+    CPPUNIT_ASSERT_EQUAL(before + 2, exported.numberofpoints);
+
+    // Bound every triangle by half its area and refine.  No triangle may
+    //   be as large as the largest was, and the domain must be unchanged.
+    std::vector<REAL> areas(exported.numberoftriangles);
+    REAL largest = 0.0;
+    for (int i = 0; i < exported.numberoftriangles; i++) {
+      areas[i] = 0.25 * doubleArea(&exported, i);
+      if (areas[i] > largest) {
+        largest = areas[i];
+      }
+    }
+    int coarse = exported.numberoftriangles;
+    freeOutput(&exported);
+    trimeshrefine(mesh, &areas[0]);
+    memset(&exported, 0, sizeof(exported));
+    trimeshexport(mesh, &exported, (struct triangulateio *) NULL);
+    CPPUNIT_ASSERT(exported.numberoftriangles > coarse);
+    REAL total = 0.0;
+    for (int i = 0; i < exported.numberoftriangles; i++) {
+      REAL area = 0.5 * doubleArea(&exported, i);
+      CPPUNIT_ASSERT(area > 0.0);
+      CPPUNIT_ASSERT(area <= largest);
+      total += area;
+    }
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(0.96, total, 1.0e-12 + COORDROUNDOFF);
+
+    // Each triangle's centroid lies in that triangle.
+    int count = exported.numberoftriangles;
+    std::vector<REAL> queries(2 * count + 2);
+    std::vector<int> found(count + 1);
+    std::vector<REAL> bary(3 * count + 3);
+    for (int i = 0; i < count; i++) {
+      for (int j = 0; j < 2; j++) {
+        queries[2 * i + j] =
+          (exported.pointlist[2 * exported.trianglelist[3 * i] + j] +
+           exported.pointlist[2 * exported.trianglelist[3 * i + 1] + j] +
+           exported.pointlist[2 * exported.trianglelist[3 * i + 2] + j]) / 3.0;
+      }
+    }
+    queries[2 * count] = 0.5;
+    queries[2 * count + 1] = 0.5;
+    CPPUNIT_ASSERT_EQUAL(count, trimeshquery(mesh, count + 1, &queries[0],
+                                             &found[0], &bary[0],
+                                             (REAL *) NULL));
+    for (int i = 0; i < count; i++) {
+      CPPUNIT_ASSERT_EQUAL(i, found[i]);
+      for (int j = 0; j < 3; j++) {
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0 / 3.0, bary[3 * i + j], 1.0e-9);
+      }
+    }
+    CPPUNIT_ASSERT_EQUAL(-1, found[count]);
+    freeOutput(&exported);
+
+    trimeshdestroy(mesh);
+  }
+
+  void testQuerySwitches() {
+    static const char *switches[4] = {"zQ", "zGQ", "zt4Q", "zGt4Q"};
+    struct triangulateio in;
+    std::vector<REAL> points;
+
+    // The attribute is linear, so it is interpolated exactly.
+    randomPoints(&in, points, 5000);
+    std::vector<REAL> attributes(in.numberofpoints);
+    for (int i = 0; i < in.numberofpoints; i++) {
+      attributes[i] = 2.0 * points[2 * i] + 3.0 * points[2 * i + 1];
+    }
+    in.numberofpointattributes = 1;
+    in.pointattributelist = &attributes[0];
+
+    // Some of the queries fall outside the unit square.
+    int count = 20000;
+    std::vector<REAL> queries(2 * count);
+    for (int i = 0; i < 2 * count; i++) {
+      queries[i] = 1.2 * random01() - 0.1;
+    }
+
+    std::vector<int> found[4];
+    std::vector<REAL> bary[4], interpolated[4];
+    for (int k = 0; k < 4; k++) {
+      char copy[16];
+      strcpy(copy, switches[k]);
+      struct trimesh *mesh = trimeshcreate(copy, &in);
+      found[k].resize(count);
+      bary[k].resize(3 * count);
+      interpolated[k].resize(count);
+      int inside = trimeshquery(mesh, count, &queries[0], &found[k][0],
+                                &bary[k][0], &interpolated[k][0]);
+      int expected = 0;
+      for (int i = 0; i < count; i++) {
+        if (found[k][i] >= 0) {
+          expected++;
+          CPPUNIT_ASSERT_DOUBLES_EQUAL(2.0 * queries[2 * i] +
+                                       3.0 * queries[2 * i + 1],
+                                       interpolated[k][i],
+                                       1.0e-9 + COORDROUNDOFF);
+        }
+      }
+      CPPUNIT_ASSERT_EQUAL(expected, inside);
+      CPPUNIT_ASSERT(inside > count / 2);
+      CPPUNIT_ASSERT(inside < count);
+      trimeshdestroy(mesh);
+    }
+
+    // The grid and the threads change how the points are found, not where.
+    for (int k = 1; k < 4; k++) {
+      CPPUNIT_ASSERT(found[k] == found[0]);
+      CPPUNIT_ASSERT(bary[k] == bary[0]);
+      CPPUNIT_ASSERT(interpolated[k] == interpolated[0]);
+    }
+  }
+
+  void testIncrementalOrder() {
+    struct triangulateio in, divconq, incremental;
+    std::vector<REAL> points;
+
+    // Random points are in general position, so the Delaunay triangulation
+    //   is unique, whatever order the vertices are inserted in.
+    randomPoints(&in, points, 20000);
+    triangulateWith("zQ", &in, &divconq);
+    triangulateWith("ziQ", &in, &incremental);
+    assertSameTriangles(&divconq, &incremental);
+    CPPUNIT_ASSERT(memcmp(divconq.pointlist, incremental.pointlist,
+                          2 * divconq.numberofpoints * sizeof(REAL)) == 0);
+    freeOutput(&divconq);
+    freeOutput(&incremental);
+
+    // Every fourth point is a copy of an earlier one.  Both algorithms keep
+    //   the copy listed first, and -j writes the same vertices.
+    for (int i = 3; i < in.numberofpoints; i += 4) {
+      int copy = (int) (random01() * (REAL) i);
+      points[2 * i] = points[2 * copy];
+      points[2 * i + 1] = points[2 * copy + 1];
+    }
+    triangulateWith("zjQ", &in, &divconq);
+    triangulateWith("zijQ", &in, &incremental);
+    CPPUNIT_ASSERT(divconq.numberofpoints < in.numberofpoints);
+    assertSameTriangles(&divconq, &incremental);
+    CPPUNIT_ASSERT(memcmp(divconq.pointlist, incremental.pointlist,
+                          2 * divconq.numberofpoints * sizeof(REAL)) == 0);
+    CPPUNIT_ASSERT(memcmp(divconq.pointmarkerlist, incremental.pointmarkerlist,
+                          divconq.numberofpoints * sizeof(int)) == 0);
+    freeOutput(&divconq);
+    freeOutput(&incremental);
+  }
+
+  void testRelayout() {
+    static const char *switches[3] = {"zQ", "pzqQ", "pzqa0.0005t4Q"};
+    struct triangulateio in, plain, relaid;
+    std::vector<REAL> points, holes;
+    std::vector<int> segments;
+
+    // -M renumbers the triangles and the Steiner points, but the mesh is
+    //   the same, and the input vertices keep their numbers.
+    for (int k = 0; k < 3; k++) {
+      char copy[32];
+      if (k == 0) {
+        randomPoints(&in, points, 20000);
+      } else {
+        squareWithHole(&in, points, segments, holes, 2000);
+      }
+      triangulateWith(switches[k], &in, &plain);
+      strcpy(copy, switches[k]);
+      copy[strlen(copy) - 1] = '\0';
+      strcat(copy, "MQ");
+      triangulateWith(copy, &in, &relaid);
+      assertSameTriangles(&plain, &relaid);
+      CPPUNIT_ASSERT(memcmp(plain.trianglelist, relaid.trianglelist,
+                            3 * plain.numberoftriangles * sizeof(int)) != 0);
+      CPPUNIT_ASSERT(memcmp(plain.pointlist, relaid.pointlist,
+                            2 * in.numberofpoints * sizeof(REAL)) == 0);
+      if (k > 0) {
+        CPPUNIT_ASSERT(plain.numberofpoints > in.numberofpoints);
+      }
+      freeOutput(&plain);
+      freeOutput(&relaid);
+    }
+  }
+
+  void testScratchFiles() {
+#if defined(__unix__) || defined(__APPLE__)
+    static const char *switches[4] = {"znQ", "zinMQ", "pznqa0.0005t4Q",
+                                      "pzneqa0.0001Q"};
+    struct triangulateio in, plain, scratch, pooled;
+    std::vector<REAL> points, holes;
+    std::vector<int> segments;
+    CountingAllocator counts = {0, 0};
+    struct triallocator allocator;
+    char directory[] = "/tmp/triangle_testXXXXXX";
+    std::string scratchdir;
+
+    // The triangles of these meshes take more than one mapped block (2 MB),
+    //   so -T backs them with files in `scratchdir', whose name is made of
+    //   switch letters that must not be read as switches.
+    CPPUNIT_ASSERT(mkdtemp(directory) != NULL);
+    scratchdir = std::string(directory) + "/pYqa1VL";
+    CPPUNIT_ASSERT_EQUAL(0, mkdir(scratchdir.c_str(), 0700));
+    allocator.allocate = countingAllocate;
+    allocator.release = countingRelease;
+    allocator.userdata = &counts;
+    struct triarena *arena = triarenacreate(&allocator);
+    for (int k = 0; k < 4; k++) {
+      char copy[64];
+      if (k < 2) {
+        randomPoints(&in, points, 40000);
+      } else {
+        squareWithHole(&in, points, segments, holes, 20000);
+      }
+      triangulateWith(switches[k], &in, &plain);
+      strcpy(copy, switches[k]);
+      strcat(copy, "T");
+      strcat(copy, scratchdir.c_str());
+      triangulateWith(copy, &in, &scratch);
+      assertSameMesh(&plain, &scratch);
+      CPPUNIT_ASSERT_EQUAL(plain.numberofedges, scratch.numberofedges);
+      freeOutput(&scratch);
+
+      // With an arena, and an allocator that can't supply the files.
+      memset(&pooled, 0, sizeof(pooled));
+      triarenatriangulate(arena, copy, &in, &pooled,
+                          (struct triangulateio *) NULL);
+      assertSameMesh(&plain, &pooled);
+      releaseOutput(&allocator, &pooled);
+      freeOutput(&plain);
+    }
+    triarenadestroy(arena);
+    CPPUNIT_ASSERT_EQUAL(0L, counts.live);
+
+    // The files were deleted as they were created, so none is left behind.
+    CPPUNIT_ASSERT_EQUAL(0, rmdir(scratchdir.c_str()));
+    CPPUNIT_ASSERT_EQUAL(0, rmdir(directory));
+#endif /* __unix__ or __APPLE__ */
+  }
+
+  void testThinGrid() {
+    // Bounding boxes far wider than they are high.  The grid must stay
+    //   about as large as the vertex count, and change nothing.  A float
+    //   can't be as small as 1.0e-300.
+#ifndef FLOATCOORDS
+    static const REAL heights[2] = {1.0e-9, 1.0e-300};
+#else /* FLOATCOORDS */
+    static const REAL heights[2] = {1.0e-9, 1.0e-30};
+#endif /* FLOATCOORDS */
+    struct triangulateio in, plain, gridded;
+    std::vector<REAL> points;
+    REAL region[4];
+
+    for (int k = 0; k < 2; k++) {
+      randomPoints(&in, points, 2000);
+      for (int i = 0; i < in.numberofpoints; i++) {
+        points[2 * i] *= 1.0e6;
+        points[2 * i + 1] *= heights[k];
+      }
+      region[0] = points[0];
+      region[1] = points[1];
+      region[2] = 7.0;
+      region[3] = 0.0;
+      in.numberofregions = 1;
+      in.regionlist = region;
+
+      triangulateWith("pznAQ", &in, &plain);
+      triangulateWith("pznAGQ", &in, &gridded);
+      assertSameMesh(&plain, &gridded);
+      CPPUNIT_ASSERT_EQUAL(1, gridded.numberoftriangleattributes);
+      for (int i = 0; i < gridded.numberoftriangles; i++) {
+        CPPUNIT_ASSERT_EQUAL(7.0, gridded.triangleattributelist[i]);
+      }
+      freeOutput(&plain);
+      freeOutput(&gridded);
+
+      // The region's point, at least, must be found from the grid.
+      char switches[] = "pznAGQ";
+      long searches, gridsearches;
+      struct trimesh *mesh = trimeshcreate(switches, &in);
+      trimeshlocatecounts(mesh, &searches, &gridsearches);
+      CPPUNIT_ASSERT(gridsearches > 0);
+      CPPUNIT_ASSERT(gridsearches <= searches);
+      trimeshdestroy(mesh);
+    }
+  }
+
+  void testIntegerExtremes() {
+    // The largest coordinate the -k switch takes.  A 64 by 64 lattice from
+    //   -limit to limit is full of cocircular vertices.  With FLOATCOORDS,
+    //   the limit is small enough that the refinement below can split the
+    //   gaps of one unit beside the lattice lines.
+#ifndef FLOATCOORDS
+    static const REAL limit = 1073741823.0;
+#else /* FLOATCOORDS */
+    static const REAL limit = 64512.0;
+#endif /* FLOATCOORDS */
+    static const int side = 64;
+    struct triangulateio in, floating, integer;
+    std::vector<REAL> points;
+
+    REAL step = 2.0 * limit / (REAL) (side - 1);
+    for (int i = 0; i < side; i++) {
+      for (int j = 0; j < side; j++) {
+        points.push_back(-limit + step * (REAL) i);
+        points.push_back(-limit + step * (REAL) j);
+      }
+    }
+    // Points just beside the lattice lines, but not on them.
+    for (int i = 0; i < 1000; i++) {
+      points.push_back(-limit + step * (REAL) (int) (random01() * (side - 1)) +
+                       1.0);
+      points.push_back((REAL) (long) ((2.0 * random01() - 1.0) * limit));
+    }
+    memset(&in, 0, sizeof(in));
+    in.numberofpoints = (int) points.size() / 2;
+    in.pointlist = &points[0];
+
+    triangulateWith("znQ", &in, &floating);
+    triangulateWith("znkQ", &in, &integer);
+    CPPUNIT_ASSERT_EQUAL(in.numberofpoints, integer.numberofpoints);
+    assertSameMesh(&floating, &integer);
+    freeOutput(&floating);
+    freeOutput(&integer);
+
+    // The same with segments and refinement, whose new vertices are not
+    //   integers, so that the integer tests must be given up part way.
+    std::vector<int> segments;
+    for (int i = 0; i < side - 1; i++) {
+      segments.push_back(i);
+      segments.push_back(i + 1);
+      segments.push_back(i * side);
+      segments.push_back((i + 1) * side);
+    }
+    in.numberofsegments = (int) segments.size() / 2;
+    in.segmentlist = &segments[0];
+    triangulateWith("pzcnq25Q", &in, &floating);
+    triangulateWith("pzcnq25kQ", &in, &integer);
+    assertSameMesh(&floating, &integer);
+    freeOutput(&floating);
+    freeOutput(&integer);
+  }
+
+  void testStaticFilters() {
+    struct triangulateio in, dynamic, fixed;
+    std::vector<REAL> points, holes;
+    std::vector<int> segments;
+
+    // The static filters decide signs sooner, but never differently.
+    randomPoints(&in, points, 20000);
+    triangulateWith("znQ", &in, &dynamic);
+    triangulateWith("znfQ", &in, &fixed);
+    assertSameMesh(&dynamic, &fixed);
+    freeOutput(&dynamic);
+    freeOutput(&fixed);
+
+    // Likewise for the Steiner points of refinement.
+    squareWithHole(&in, points, segments, holes, 2000);
+    triangulateWith("pznq33a0.0001Q", &in, &dynamic);
+    triangulateWith("pznq33a0.0001fQ", &in, &fixed);
+    assertSameMesh(&dynamic, &fixed);
+    freeOutput(&dynamic);
+    freeOutput(&fixed);
+  }
+
+  // Triangulates `in' with `switches' in the FMA library.
+  void fusedTriangulateWith(const char *switches, struct triangulateio *in,
+                            struct triangulateio *out) {
+    char copy[64];
+    strcpy(copy, switches);
+    memset(out, 0, sizeof(*out));
+    trifma_triangulate(copy, (struct trifma_triangulateio *) in,
+                       (struct trifma_triangulateio *) out,
+                       (struct trifma_triangulateio *) NULL);
+  }
+
+  // Fills `in' with `count' points on the unit circle, rounded, so that
+  //   nearly every incircle test is within a few roundoffs of zero.
+  void nearlyCocircular(struct triangulateio *in, std::vector<REAL> &points,
+                        int count) {
+    points.resize(2 * count);
+    for (int i = 0; i < count; i++) {
+      REAL angle = 6.283185307179586 * (REAL) i / (REAL) count;
+      points[2 * i] = cos(angle);
+      points[2 * i + 1] = sin(angle);
+    }
+    memset(in, 0, sizeof(*in));
+    in->numberofpoints = count;
+    in->pointlist = &points[0];
+  }
+
+  // Fills `in' with a `size' by `size' grid whose columns lean by a few
+  //   units in the last place, so that nearly every orientation test is
+  //   within a few roundoffs of zero too.
+  void nearlyCollinear(struct triangulateio *in, std::vector<REAL> &points,
+                       int size) {
+    points.clear();
+    for (int i = 0; i < size; i++) {
+      for (int j = 0; j < size; j++) {
+        REAL y = (REAL) j / (REAL) size;
+        points.push_back((REAL) i / (REAL) size +
+                         (REAL) (j % 3) * 2.220446049250313e-16 * y);
+        points.push_back(y);
+      }
+    }
+    memset(in, 0, sizeof(*in));
+    in->numberofpoints = size * size;
+    in->pointlist = &points[0];
+  }
+
+  void testFusedPredicates() {
+    static const char *switches[5] = {"znQ", "zinQ", "zFnQ", "zneQ", "znqQ"};
+    struct triangulateio in, plain, fused;
+    std::vector<REAL> points;
+
+    // Products whose roundoff is found by fma() give the predicates the
+    //   same signs as Dekker's splitting, and so the same meshes.  Only
+    //   the circle is refined; the hull of the grid is lined with slivers
+    //   a few roundoffs thick, which -q can't mend.
+    for (int shape = 0; shape < 2; shape++) {
+      if (shape == 0) {
+        nearlyCocircular(&in, points, 3000);
+      } else {
+        nearlyCollinear(&in, points, 60);
+      }
+      for (int k = 0; k < 5 - shape; k++) {
+        triangulateWith(switches[k], &in, &plain);
+        fusedTriangulateWith(switches[k], &in, &fused);
+        assertSameMesh(&plain, &fused);
+        CPPUNIT_ASSERT_EQUAL(plain.numberofedges, fused.numberofedges);
+        freeOutput(&plain);
+        freeOutput(&fused);
+      }
+    }
+
+    // Queries on and beside the leaning columns are found in the same
+    //   triangles, which only the orientation tests decide.
+    std::vector<REAL> queries;
+    for (int i = 0; i + 1 < in.numberofpoints; i++) {
+      REAL x = 0.5 * (points[2 * i] + points[2 * i + 2]);
+      REAL y = 0.5 * (points[2 * i + 1] + points[2 * i + 3]);
+      queries.push_back(x);
+      queries.push_back(y);
+      queries.push_back(nextafter(x, 2.0));
+      queries.push_back(y);
+      queries.push_back(nextafter(x, -1.0));
+      queries.push_back(y);
+    }
+    int count = (int) queries.size() / 2;
+    std::vector<int> found(count), fusedfound(count);
+    char copy[] = "zQ";
+    struct trimesh *mesh = trimeshcreate(copy, &in);
+    struct trifma_trimesh *fusedmesh =
+      trifma_trimeshcreate(copy, (struct trifma_triangulateio *) &in);
+    CPPUNIT_ASSERT_EQUAL(trimeshquery(mesh, count, &queries[0], &found[0],
+                                      (REAL *) NULL, (REAL *) NULL),
+                         trifma_trimeshquery(fusedmesh, count, &queries[0],
+                                             &fusedfound[0], (REAL *) NULL,
+                                             (REAL *) NULL));
+    CPPUNIT_ASSERT(found == fusedfound);
+    trimeshdestroy(mesh);
+    trifma_trimeshdestroy(fusedmesh);
+  }
+
+  void testBothPrecisions() {
+    struct triangulateio in, out;
+    struct trif_triangulateio inf, outf;
+    std::vector<REAL> points;
+    char switches[] = "zQ";
+
+    // Points that single precision holds exactly.
+    randomPoints(&in, points, 2000);
+    std::vector<float> pointsf(points.size());
+    for (size_t i = 0; i < points.size(); i++) {
+      pointsf[i] = (float) points[i];
+      points[i] = (REAL) pointsf[i];
+    }
+    memset(&inf, 0, sizeof(inf));
+    inf.numberofpoints = in.numberofpoints;
+    inf.pointlist = &pointsf[0];
+
+    memset(&outf, 0, sizeof(outf));
+    trif_triangulate(switches, &inf, &outf, (struct trif_triangulateio *) NULL);
+    triangulateWith("zQ", &in, &out);
+
+    // Exact predicates give the same Delaunay triangulation in both.
+    CPPUNIT_ASSERT_EQUAL(out.numberofpoints, outf.numberofpoints);
+    CPPUNIT_ASSERT_EQUAL(out.numberoftriangles, outf.numberoftriangles);
+    CPPUNIT_ASSERT(memcmp(out.trianglelist, outf.trianglelist,
+                          3 * out.numberoftriangles * sizeof(int)) == 0);
+    for (int i = 0; i < 2 * out.numberofpoints; i++) {
+      CPPUNIT_ASSERT_EQUAL(out.pointlist[i], (REAL) outf.pointlist[i]);
+    }
+    freeOutput(&out);
+    trif_trifree(outf.pointlist);
+    trif_trifree(outf.pointmarkerlist);
+    trif_trifree(outf.trianglelist);
+  }
+
+  // Triangulates `in' with `switches' in the COMPACT library.  Its
+  //   triangulateio is the same structure as ours under another name.
+  void compactTriangulateWith(const char *switches, struct triangulateio *in,
+                              struct triangulateio *out) {
+    char copy[64];
+    strcpy(copy, switches);
+    memset(out, 0, sizeof(*out));
+    tric_triangulate(copy, (struct tric_triangulateio *) in,
+                     (struct tric_triangulateio *) out,
+                     (struct tric_triangulateio *) NULL);
+  }
+
+  void testCompactLinks() {
+    static const char *pointswitches[5] = {"znQ", "zinQ", "zFnQ", "zneQ",
+                                           "cznqa0.00002Ut4Q"};
+    static const char *polyswitches[4] = {"pznQ", "pznqa0.0005Q",
+                                          "pznqa0.0005t4Q", "pznAaDQ"};
+    struct triangulateio in, pointer, compact;
+    std::vector<REAL> points, holes;
+    std::vector<int> segments;
+
+    // Links stored as indices instead of pointers change nothing else.
+    randomPoints(&in, points, 20000);
+    for (int k = 0; k < 5; k++) {
+      triangulateWith(pointswitches[k], &in, &pointer);
+      compactTriangulateWith(pointswitches[k], &in, &compact);
+      assertSameMesh(&pointer, &compact);
+      CPPUNIT_ASSERT_EQUAL(pointer.numberofedges, compact.numberofedges);
+      freeOutput(&pointer);
+      freeOutput(&compact);
+    }
+    squareWithHole(&in, points, segments, holes, 2000);
+    for (int k = 0; k < 4; k++) {
+      triangulateWith(polyswitches[k], &in, &pointer);
+      compactTriangulateWith(polyswitches[k], &in, &compact);
+      assertSameMesh(&pointer, &compact);
+      freeOutput(&pointer);
+      freeOutput(&compact);
+    }
+
+    // Segments that cross, so that some are split where they meet.
+    stripes(&in, points, segments, 5000);
+    triangulateWith("pznQ", &in, &pointer);
+    compactTriangulateWith("pznQ", &in, &compact);
+    assertSameMesh(&pointer, &compact);
+    freeOutput(&pointer);
+    freeOutput(&compact);
+  }
+
+  // Triangulates `in' with `switches' in the FLOATCOORDS library.
+  void floatTriangulateWith(const char *switches, struct triangulateio *in,
+                            struct triangulateio *out) {
+    char copy[64];
+    strcpy(copy, switches);
+    memset(out, 0, sizeof(*out));
+    trifc_triangulate(copy, (struct trifc_triangulateio *) in,
+                      (struct trifc_triangulateio *) out,
+                      (struct trifc_triangulateio *) NULL);
+  }
+
+  // Rounds `points' and `holes' to single precision.
+  void roundToFloat(std::vector<REAL> &points, std::vector<REAL> &holes) {
+    for (size_t i = 0; i < points.size(); i++) {
+      points[i] = (REAL) (float) points[i];
+    }
+    for (size_t i = 0; i < holes.size(); i++) {
+      holes[i] = (REAL) (float) holes[i];
+    }
+  }
+
+  void testFloatCoords() {
+    static const char *pointswitches[4] = {"znQ", "zinQ", "zFnQ", "zneQ"};
+    static const char *polyswitches[2] = {"pznQ", "pzncQ"};
+    struct triangulateio in, wide, narrow;
+    std::vector<REAL> points, holes;
+    std::vector<int> segments;
+
+    // Vertices that single precision holds exactly are triangulated alike,
+    //   for the predicates are exact on the coordinates read back.
+    //   Points nearly on a circle leave many tests to the exact arithmetic.
+    for (int shape = 0; shape < 2; shape++) {
+      if (shape == 0) {
+        randomPoints(&in, points, 20000);
+      } else {
+        nearlyCocircular(&in, points, 3000);
+      }
+      roundToFloat(points, holes);
+      for (int k = 0; k < 4; k++) {
+        triangulateWith(pointswitches[k], &in, &wide);
+        floatTriangulateWith(pointswitches[k], &in, &narrow);
+        assertSameMesh(&wide, &narrow);
+        CPPUNIT_ASSERT_EQUAL(wide.numberofedges, narrow.numberofedges);
+        freeOutput(&wide);
+        freeOutput(&narrow);
+      }
+    }
+    squareWithHole(&in, points, segments, holes, 2000);
+    roundToFloat(points, holes);
+    for (int k = 0; k < 2; k++) {
+      triangulateWith(polyswitches[k], &in, &wide);
+      floatTriangulateWith(polyswitches[k], &in, &narrow);
+      assertSameMesh(&wide, &narrow);
+      freeOutput(&wide);
+      freeOutput(&narrow);
+    }
+
+    // Steiner points are rounded as they are made, and the mesh is still
+    //   a good one.
+    floatTriangulateWith("pznqa0.00005Q", &in, &narrow);
+    assertQuality(&narrow, 0.00005);
+    for (int i = 0; i < 2 * narrow.numberofpoints; i++) {
+      CPPUNIT_ASSERT_EQUAL(narrow.pointlist[i],
+                           (REAL) (float) narrow.pointlist[i]);
+    }
+    freeOutput(&narrow);
+  }
+
+  // Triangulates `in' with `switches' in the COLDSTORE library.
+  void coldTriangulateWith(const char *switches, struct triangulateio *in,
+                           struct triangulateio *out) {
+    char copy[64];
+    strcpy(copy, switches);
+    memset(out, 0, sizeof(*out));
+    tricold_triangulate(copy, (struct tricold_triangulateio *) in,
+                        (struct tricold_triangulateio *) out,
+                        (struct tricold_triangulateio *) NULL);
+  }
+
+  // Asserts that two outputs of the same mesh have the same vertex and
+  //   triangle attributes.  With FLOATCOORDS, the vertex attributes are
+  //   rounded to single precision in the vertex records but not in the
+  //   companions of COLDSTORE, and Steiner points extrapolate the roundoff,
+  //   so only their number is compared.
+  void assertSameAttributes(struct triangulateio *a,
+                            struct triangulateio *b) {
+    CPPUNIT_ASSERT_EQUAL(a->numberofpointattributes,
+                         b->numberofpointattributes);
+    CPPUNIT_ASSERT_EQUAL(a->numberoftriangleattributes,
+                         b->numberoftriangleattributes);
+#ifndef FLOATCOORDS
+    if (a->numberofpointattributes > 0) {
+      CPPUNIT_ASSERT(memcmp(a->pointattributelist, b->pointattributelist,
+                            a->numberofpoints * a->numberofpointattributes *
+                            sizeof(REAL)) == 0);
+    }
+#endif /* not FLOATCOORDS */
+    if (a->numberoftriangleattributes > 0) {
+      CPPUNIT_ASSERT(memcmp(a->triangleattributelist,
+                            b->triangleattributelist,
+                            a->numberoftriangles *
+                            a->numberoftriangleattributes *
+                            sizeof(REAL)) == 0);
+    }
+  }
+
+  // Gives each vertex of `in' two attributes, one linear and one random.
+  void twoAttributes(struct triangulateio *in, std::vector<REAL> &attributes) {
+    attributes.resize(2 * in->numberofpoints);
+    for (int i = 0; i < in->numberofpoints; i++) {
+      attributes[2 * i] = in->pointlist[2 * i] -
+                          2.0 * in->pointlist[2 * i + 1];
+      attributes[2 * i + 1] = random01();
+    }
+    in->numberofpointattributes = 2;
+    in->pointattributelist = &attributes[0];
+  }
+
+  void testColdStore() {
+    static const char *pointswitches[3] = {"znQ", "zinQ", "zFnQ"};
+    static const char *polyswitches[5] = {"pznAQ", "pznAaQ", "pznAaqQ",
+                                          "pznAaqUt4Q", "pznAaqMQ"};
+    static const char *refineswitches[2] = {"rpznaqQ", "rznaqQ"};
+    static const REAL cut[8] = {0.5, 0.0, 0.5, 0.4, 0.5, 0.6, 0.5, 1.0};
+    static const REAL region[8] = {0.1, 0.1, 1.0, 0.001,
+                                   0.9, 0.1, 2.0, 0.0002};
+    struct triangulateio in, hot, cold, first, again;
+    std::vector<REAL> points, holes, attributes, regions, areas;
+    std::vector<int> segments;
+
+    // Attributes and area bounds kept in companion records change nothing.
+    //   Each vertex has two attributes, which Steiner points interpolate.
+    //   -i starts from a bounding triangle, whose vertices have companions
+    //   too.
+    randomPoints(&in, points, 20000);
+    twoAttributes(&in, attributes);
+    for (int k = 0; k < 3; k++) {
+      triangulateWith(pointswitches[k], &in, &hot);
+      coldTriangulateWith(pointswitches[k], &in, &cold);
+      assertSameMesh(&hot, &cold);
+      assertSameAttributes(&hot, &cold);
+      freeOutput(&hot);
+      freeOutput(&cold);
+    }
+
+    // Two regions, the halves of the square on either side of x = 0.5,
+    //   with their own attributes and area bounds.  -M copies the records
+    //   and their companions.
+    squareWithHole(&in, points, segments, holes, 2000);
+    for (int k = 0; k < 4; k++) {
+      segments.push_back(in.numberofpoints + k);
+      points.push_back(cut[2 * k]);
+      points.push_back(cut[2 * k + 1]);
+    }
+    in.numberofpoints += 4;
+    in.pointlist = &points[0];
+    in.numberofsegments += 2;
+    in.segmentlist = &segments[0];
+    regions.assign(region, region + 8);
+    in.numberofregions = 2;
+    in.regionlist = &regions[0];
+    twoAttributes(&in, attributes);
+    for (int k = 0; k < 5; k++) {
+      triangulateWith(polyswitches[k], &in, &hot);
+      coldTriangulateWith(polyswitches[k], &in, &cold);
+      assertSameMesh(&hot, &cold);
+      assertSameAttributes(&hot, &cold);
+      freeOutput(&hot);
+      freeOutput(&cold);
+    }
+
+    // Refining the mesh read back with -r, under a bound for every third
+    //   triangle, with and without its segments.
+    triangulateWith("pznAaqQ", &in, &first);
+    memset(&again, 0, sizeof(again));
+    again.numberofpoints = first.numberofpoints;
+    again.pointlist = first.pointlist;
+    again.numberofpointattributes = first.numberofpointattributes;
+    again.pointattributelist = first.pointattributelist;
+    again.pointmarkerlist = first.pointmarkerlist;
+    again.numberoftriangles = first.numberoftriangles;
+    again.numberofcorners = 3;
+    again.trianglelist = first.trianglelist;
+    again.numberoftriangleattributes = first.numberoftriangleattributes;
+    again.triangleattributelist = first.triangleattributelist;
+    areas.resize(first.numberoftriangles);
+    for (int t = 0; t < first.numberoftriangles; t++) {
+      areas[t] = (t % 3 == 0) ? 0.00005 : -1.0;
+    }
+    again.trianglearealist = &areas[0];
+    again.numberofsegments = first.numberofsegments;
+    again.segmentlist = first.segmentlist;
+    again.segmentmarkerlist = first.segmentmarkerlist;
+    again.numberofholes = in.numberofholes;
+    again.holelist = in.holelist;
+    for (int k = 0; k < 2; k++) {
+      triangulateWith(refineswitches[k], &again, &hot);
+      coldTriangulateWith(refineswitches[k], &again, &cold);
+      CPPUNIT_ASSERT(hot.numberoftriangles > first.numberoftriangles);
+      assertSameMesh(&hot, &cold);
+      assertSameAttributes(&hot, &cold);
+      freeOutput(&hot);
+      freeOutput(&cold);
+    }
+    freeOutput(&first);
+  }
+
+  // Frees an output of triarenatriangulate() with the allocator's callback.
+  void releaseOutput(struct triallocator *allocator,
+                     struct triangulateio *out) {
+    void *lists[10] = {out->pointlist, out->pointattributelist,
+                       out->pointmarkerlist, out->trianglelist,
+                       out->triangleattributelist, out->neighborlist,
+                       out->segmentlist, out->segmentmarkerlist,
+                       out->edgelist, out->edgemarkerlist};
+    for (int i = 0; i < 10; i++) {
+      if (lists[i] != NULL) {
+        allocator->release(allocator->userdata, lists[i]);
+      }
+    }
+  }
+
+  void testArenaAllocator() {
+    static const char *switches[4] = {"pzneQ", "pznqa0.001Q", "pznqa0.01Q",
+                                      "pznqaQ"};
+    struct triangulateio in, direct, pooled;
+    std::vector<REAL> points, holes;
+    std::vector<int> segments;
+    CountingAllocator counts = {0, 0};
+    struct triallocator allocator;
+
+    allocator.allocate = countingAllocate;
+    allocator.release = countingRelease;
+    allocator.userdata = &counts;
+    struct triarena *arena = triarenacreate(&allocator);
+    CPPUNIT_ASSERT(arena != NULL);
+
+    // Inputs of several sizes, so that the kept pools grow and shrink.
+    for (int k = 0; k < 12; k++) {
+      char copy[16];
+      squareWithHole(&in, points, segments, holes, 10 + (k * 97) % 400);
+      triangulateWith(switches[k % 4], &in, &direct);
+      strcpy(copy, switches[k % 4]);
+      memset(&pooled, 0, sizeof(pooled));
+      triarenatriangulate(arena, copy, &in, &pooled,
+                          (struct triangulateio *) NULL);
+      assertSameMesh(&direct, &pooled);
+      CPPUNIT_ASSERT_EQUAL(direct.numberofedges, pooled.numberofedges);
+      freeOutput(&direct);
+      releaseOutput(&allocator, &pooled);
+    }
+
+    CPPUNIT_ASSERT(counts.allocated > 0);
+    triarenadestroy(arena);
+    CPPUNIT_ASSERT_EQUAL(0L, counts.live);
+  }
+
+  unsigned long long seed;
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(TriangleTest);